@@ -4,11 +4,14 @@
 #include <filesystem>
 #include <chrono>
 #include <string.h>
+#include <atomic>
+#include <csignal>
 #include "json.hpp"
 #include <boost/program_options.hpp>
 #include <boost/date_time.hpp>
 #include <boost/filesystem.hpp>
 #include "history.hpp"
+#include "snapshot.hpp"
 #include <regex>
 
 #include "readline/readline.h"
@@ -21,14 +24,28 @@ namespace po = boost::program_options;
 namespace fs = std::filesystem;
 
 bool verbose = false;
+bool fullHistory = false;
 int numSplits = 6;
 int limit = 10;
+int limitSeconds = 0;
 int minNumberOfObservations = numSplits;
 int maxNumberOfPattern = 1000;
+bool bestPattern = false;
+int maxMineMillis = 0;
+int queryCacheSize = 32;
+int numThreads = 0; // 0 uses all cores
+std::atomic<bool> mineCancel(false); // set by Ctrl-C while we mine
 std::string cmd("");
+std::string snapshotFile("");
+std::string sweep("");
 json summaryJSON;
 
 
+// Ctrl-C during mining stops only the mining, we keep the history and the pattern found so far
+void cancelMine(int) {
+    mineCancel = true;
+}
+
 inline bool ends_with(std::string const & value, std::string const & ending) {
     if (ending.size() > value.size()) return false;
     return std::equal(ending.rbegin(), ending.rend(), value.rbegin());
@@ -116,12 +133,20 @@ int main(int argc, char *argv[]) {
     desc.add_options()
       ("help,h", "Print this help.")
       ("numSplits,s", po::value< int >(&numSplits), "Number of splits used to represent single history as sequences [6].")
-      ("limit,l", po::value< int >(&limit), "Limit the maximum distance allowed between log entries [10].")
+      ("limit,l", po::value< int >(&limit), "Limit the maximum distance allowed between log entries [10, 0 no limit].")
+      ("limitSeconds", po::value< int >(&limitSeconds), "Limit the maximum time in seconds allowed between log entries [0, no limit]. Works together with --limit, use '-l 0' to limit only the time.")
       ("minNumberOfObservations,m", po::value< int >(&minNumberOfObservations), "An event has to occur at least that many times [3]. Can be set the same as numSplits.")
       ("maxNumberOfPattern,e", po::value< int >(&maxNumberOfPattern), "Some logs can produce a very large number of pattern, stop generating more if you reach this limit [1000].")
+      ("best", po::bool_switch(&bestPattern), "Keep the maxNumberOfPattern pattern with the largest support instead of the first ones found, most frequent first. Searching stops early in parts that cannot beat them.")
+      ("maxMineMillis", po::value< int >(&maxMineMillis), "Stop searching for pattern after that many milliseconds and show the ones found so far [0, no limit]. Ctrl-C does the same.")
+      ("threads", po::value< int >(&numThreads), "Number of cores used to import log files and to search for pattern [0, all cores]. '--threads 1' searches serially.")
+      ("queryCache", po::value< int >(&queryCacheSize), "Keep the pattern of that many REPL queries, asking again for the same window and settings prints them without mining [32, 0 disables].")
       ("cmd,c", po::value< std::string >(&cmd), "Run this command [.5 300].")
+      ("sweep", po::value< std::string >(&sweep), "Instead of the REPL search for pattern in windows over the whole history and print them as JSON. Windows are 'step,width' entries or 'step,widths' seconds.")
       ("version,V", "Print the version number.")
       ("verbose,v", po::bool_switch(&verbose), "Print more verbose output during processing.")
+      ("full,f", po::bool_switch(&fullHistory), "Import the whole history of each log file (memory mapped), not only the last 8MB.")
+      ("snapshot", po::value< std::string >(&snapshotFile), "Keep the imported history in this binary file. On the next start only log files that changed since are read.")
       ("logfiles", po::value< vector<string> >(), "Log files, either folder or list of .log files. We assume that log entries are prefixed with 'Y-m-d H:M:S:'.")
     ;
     // allow positional arguments to map to logfiles
@@ -149,6 +174,13 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
+    if (numThreads < 0) {
+        fprintf(stderr, "Error: threads argument should be 0 (all cores) or larger [%d]\n", numThreads);
+        return -1;
+    }
+    // all parallel work (import and mining) runs in this arena, more threads than cores do not help
+    tbb::task_arena arena(numThreads > 0 ? std::min(numThreads, tbb::this_task_arena::max_concurrency()) : tbb::task_arena::automatic);
+
     summaryJSON["command_line"] = json::array();
     for (int i = 0; i < argc; i++) {
         summaryJSON["command_line"].push_back(std::string(argv[i]));
@@ -194,11 +226,15 @@ int main(int argc, char *argv[]) {
 
     // create history and add events to it
     history_t history;
-    for (int i = 0; i < log_files.size(); i++) {
-        if (verbose)
-            fprintf(stderr, "Reading %s\n", log_files[i].filename.c_str());
-        updateHistory(&history, &(log_files[i]));
+    if (snapshotFile != "") {
+        auto startTime = std::chrono::steady_clock::now();
+        if (loadSnapshot(snapshotFile, &history, &log_files) && verbose)
+            fprintf(stdout, "Loaded %zu entries from snapshot %s in %.3fs\n", history.size(), snapshotFile.c_str(),
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
     }
+    int numAdded = arena.execute([&]() { return updateHistory(&history, &log_files); }); // parse all files in parallel
+    if (snapshotFile != "" && numAdded > 0)
+        saveSnapshot(snapshotFile, &history, &log_files);
     // upload yet again (hopefully no duplicates now)
     //for (int i = 0; i < log_files.size(); i++) {
     //    updateHistory(&history, &(log_files[i]));
@@ -214,6 +250,78 @@ int main(int argc, char *argv[]) {
         fprintf(stdout, "\t%d %s\n", i-3, localHistory[i].toString().c_str());
     }*/
 
+    if (sweep != "") { // batch mode, mine the whole history window by window
+        std::smatch sm;
+        if (!std::regex_match(sweep, sm, std::regex(" *([0-9]+) *[, ] *([0-9]+) *(s?) *"))) {
+            fprintf(stderr, "Error: sweep argument should be 'step,width' (entries) or 'step,widths' (seconds) [%s]\n", sweep.c_str());
+            return -1;
+        }
+        int64_t step = std::stoll(sm[1].str());
+        int64_t width = std::stoll(sm[2].str());
+        bool timeUnits = sm[3].length() > 0;
+
+        // one dictionary for all windows, it is build only once and pattern of different windows use the same numbers
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<uint32_t> labels(history.numLabels());
+        for (uint32_t i = 0; i < labels.size(); i++)
+            labels[i] = i;
+        event_dictionary_t dict = makeEventDictionary(&history, labels);
+        mineCancel = false;
+        auto previousHandler = std::signal(SIGINT, cancelMine);
+        std::vector<sweep_window_t> windows = arena.execute([&]() {
+            return sweepHistory(&history, dict, step, width, timeUnits, numSplits, limit, limitSeconds, minNumberOfObservations, maxNumberOfPattern,
+                                bestPattern, maxMineMillis, &mineCancel);
+        });
+        std::signal(SIGINT, previousHandler);
+        if (verbose)
+            fprintf(stderr, "Mined %zu windows in %.3fs\n", windows.size(), std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+
+        // timeline of pattern, events are listed once and pattern refer to them by index
+        std::map<int, int> used;
+        for (int i = 0; i < windows.size(); i++)
+            for (int j = 0; j < windows[i].patterns.size(); j++)
+                for (int k = 0; k < windows[i].patterns[j].size()-1; k++)
+                    used[windows[i].patterns[j][k]] = 0;
+        json result = json::object();
+        result["step"] = step;
+        result["width"] = width;
+        result["units"] = timeUnits ? "seconds" : "entries";
+        result["events"] = json::array();
+        for (auto it = used.begin(); it != used.end(); it++) {
+            (*it).second = result["events"].size();
+            result["events"].push_back(dict.names[(*it).first]);
+        }
+        result["windows"] = json::array();
+        for (int i = 0; i < windows.size(); i++) {
+            const history_window_t &w = windows[i].window;
+            json window = json::object();
+            window["begin"] = w.begin;
+            window["end"] = w.end;
+            std::stringstream startString, endString;
+            std::tm t = fromEpochNanos(history.time[w.begin]);
+            startString << std::put_time(&t, "%Y-%m-%d %H:%M:%S");
+            t = fromEpochNanos(history.time[w.end-1]);
+            endString << std::put_time(&t, "%Y-%m-%d %H:%M:%S");
+            window["start_time"] = startString.str();
+            window["end_time"] = endString.str();
+            if (windows[i].interrupted)
+                window["interrupted"] = true;
+            window["patterns"] = json::array();
+            for (int j = 0; j < windows[i].patterns.size(); j++) {
+                const std::vector<int> &pattern = windows[i].patterns[j];
+                json entry = json::object();
+                entry["events"] = json::array();
+                for (int k = 0; k < pattern.size()-1; k++)
+                    entry["events"].push_back(used[pattern[k]]);
+                entry["support"] = pattern[pattern.size()-1];
+                window["patterns"].push_back(entry);
+            }
+            result["windows"].push_back(window);
+        }
+        std::cout << std::setw(4) << result << std::endl;
+        return 0;
+    }
+
     // use a REPL for user interaction
     int location = history.size()/2;
     fprintf(stdout, "Instructions: \n\t.5, 0.0004\n");
@@ -224,6 +332,7 @@ int main(int argc, char *argv[]) {
     bool display = false;
     bool saveToFile = false;
     std::string saveToFileFilename("");
+    PatternCache cache(std::max(queryCacheSize, 0));
     while ((line = readline(">>> ")) != nullptr) {
         if (line && *line) 
             add_history(line);
@@ -241,6 +350,18 @@ int main(int argc, char *argv[]) {
                 // std::free((void *)line);
                 continue; 
             }
+            if (std::string(cmd) == "update") { // import whatever was appended to the log files since the last read
+                int numAdded = arena.execute([&]() { return updateHistory(&history, &log_files); });
+                if (snapshotFile != "" && numAdded > 0)
+                    saveSnapshot(snapshotFile, &history, &log_files);
+                fprintf(stdout, "added %d new entr%s, history has now %zu entries\n", numAdded, numAdded!=1?"ies":"y", history.size());
+                if (numAdded > 0) {
+                    int numDropped = cache.invalidate(&history);
+                    if (verbose && numDropped > 0)
+                        fprintf(stdout, "%d cached quer%s changed\n", numDropped, numDropped!=1?"ies":"y");
+                }
+                continue;
+            }
             // check if we want to save the result to a file
             std::regex word_regex("save ([\\w.]+)");
             std::smatch sm;
@@ -270,19 +391,44 @@ int main(int argc, char *argv[]) {
 
             fprintf(stdout, "location %d with window ±%d\n", location, width);
             // get local history in seconds around an event
-            std::vector<HistoryEntry> localHistory2;
+            history_window_t localHistory2;
             if (timeUnits) {
                 localHistory2 = getLocalHistoryDuration(&history, location, width); // seconds around this element
             } else {
                 localHistory2 = getLocalHistory(&history, location, width);
             }
             fprintf(stdout, "Specific local time history entries [location: %d, width: %d]\n", location, width);
-            for (int i = 0; i < localHistory2.size(); i++) {
-                fprintf(stdout, "  %03d %s\n", i+1, localHistory2[i].toString().c_str());
+            for (size_t i = localHistory2.begin; i < localHistory2.end; i++) {
+                fprintf(stdout, "  %03zu %s\n", i - localHistory2.begin + 1, toString(&history, i).c_str());
             }
 
-            // see if we have repeating things
-            std::pair< std::vector<std::vector< std::string > >, std::vector<int> > res = detectEvent(&localHistory2, numSplits, limit, minNumberOfObservations, maxNumberOfPattern);
+            // see if we have repeating things, or if we did this before
+            pattern_query_t query = PatternCache::query(localHistory2, numSplits, limit, limitSeconds, minNumberOfObservations, maxNumberOfPattern, bestPattern);
+            const pattern_result_t *cached = (query.size > 0) ? cache.find(query) : NULL;
+            std::pair< std::vector<std::vector< std::string > >, std::vector<int> > res;
+            if (cached) {
+                for (int i = 0; i < cached->events.size(); i++)
+                    printPattern(i, cached->events[i], cached->support[i], cached->patternShift[i]);
+                if (cached->events.size() == 0)
+                    fprintf(stdout, "\033[31mNo pattern detected...\033[0m\n");
+                fprintf(stdout, "(%zu pattern from the query cache)\n", cached->events.size());
+                res = std::make_pair(cached->events, cached->patternShift);
+            } else {
+                mineCancel = false;
+                auto previousHandler = std::signal(SIGINT, cancelMine);
+                std::vector<int> support;
+                bool interrupted = false;
+                // the pattern strings are only kept if they go into the cache, a file or the display
+                bool cacheable = queryCacheSize > 0 && query.size > 0;
+                bool keepPatterns = cacheable || saveToFile || display;
+                res = arena.execute([&]() {
+                    return detectEvent(localHistory2, numSplits, limit, limitSeconds, minNumberOfObservations, maxNumberOfPattern, bestPattern, keepPatterns,
+                                       maxMineMillis, &mineCancel, cacheable ? &support : NULL, &interrupted);
+                });
+                std::signal(SIGINT, previousHandler);
+                if (cacheable && !interrupted) // pattern found so far are not the answer to the query
+                    cache.insert(query, pattern_result_t{ res.first, support, res.second });
+            }
             if (saveToFile) {
                 // store result in a file, TODO: use the shift variable for vertical alignment
                 json result = json::array();
@@ -317,8 +463,9 @@ int main(int argc, char *argv[]) {
         // this requires C++ version 20
         ar["last_imported_time"] = std::format("{}", log_files[i].last_imported_time);
         ar["last_write_time"] = std::format("{}", log_files[i].last_write_time);
-        ar["num_entries"] = log_files[i].linear_event_list.size();
+        ar["num_entries"] = log_files[i].num_entries;
         ar["num_imported"] = log_files[i].num_imported;
+        ar["last_offset"] = log_files[i].last_offset;
         summaryJSON["logs"].push_back(ar);
     }
 
@@ -0,0 +1,23 @@
+// -*- coding: utf-8 -*-
+// SPDX-License-Identifier: GPL-2.0
+
+#pragma once
+
+#include <memory_resource>
+#include <utility>
+
+// Memory of a mining run. MDD nodes and patterns (and the lists they point to) are created from a
+// memory resource instead of new/delete. The MDD is built once and never changes, it lives in a
+// monotonic arena (so does an MDD kept for sliding windows, see Mdd_db). Patterns come and go during
+// the search, they use a pool per search so memory of finished patterns is reused. Everything is
+// released at once when the resource goes away.
+
+template <class T, class... Args>
+T* Arena_new(std::pmr::memory_resource* mr, Args&&... args) {
+	return std::pmr::polymorphic_allocator<>(mr).new_object<T>(std::forward<Args>(args)...);
+}
+
+template <class T>
+void Arena_delete(std::pmr::memory_resource* mr, T* p) {
+	std::pmr::polymorphic_allocator<>(mr).delete_object(p);
+}
@@ -8,7 +8,7 @@
 #include "build_mdd.hpp"
 
 //Populates the MDD node vector
-void Popl_nodes(vector<Node*>* datab_m, vector<Pattern*>* dfs_q, int N, int L, int num_att,vector<int>* max_attrs, vector<int>* min_attrs,
+void Popl_nodes(Node_table* datab_m, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* dfs_q, int N, int L, int num_att,vector<int>* max_attrs, vector<int>* min_attrs,
                 vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
                 vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi,
                 vector<int>* lavri, vector<int>* uavri,
@@ -22,13 +22,13 @@ void Intlz_DFS(vector<Pattern*>* DFS_queue, int ID, Node* fnod, Node* tnod, vect
                 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed,
                 vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr);		//Initializes the DFS pattern queue with every possible sized one pattern that can be extended
 
-void Add_arc(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue, int ID, int strp, int endp, int L, int num_att, vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items,
+void Add_arc(Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* DFS_queue, int ID, int strp, int endp, int L, int num_att, vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items,
                 vector<vector<vector<int> > >* attrs, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
                 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed,
                 vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr);		//Adds an arc to the MDD database
 
-//Constructs an empty node
-void Intlz_node(int nod, vector<Node*>* datab_MDD);
+//Constructs an empty node if there is none for this key yet, returns the node
+Node* Intlz_node(int64_t nod, Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay);
 
 //Checks satisfaction of gap constraints
 bool Check_gap(int i, int strt, int endp, vector<vector<vector<int> > >* attrs, vector<int>* lgapi,
@@ -36,7 +36,7 @@ bool Check_gap(int i, int strt, int endp, vector<vector<vector<int> > >* attrs,
 
 
 // Build MDD. It is called from minig function
-void Build_MDD(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue,
+void Build_MDD(Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* DFS_queue,
                             vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni,
                             vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, vector<int>* lmedi,
                             vector<int>* lgap, vector<int>* ugap, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed,
@@ -46,55 +46,64 @@ void Build_MDD(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue,
                             vector<vector<int> >* items,
                             vector<vector<vector<int> > >* attrs) {
 
-	Popl_nodes(datab_MDD, DFS_queue, N, L, num_att, max_attrs, min_attrs, items, attrs, lgapi, ugapi, lspni, lmedi, umedi, lavri, uavri,
+	Popl_nodes(datab_MDD, mr, lay, DFS_queue, N, L, num_att, max_attrs, min_attrs, items, attrs, lgapi, ugapi, lspni, lmedi, umedi, lavri, uavri,
 		lgap, ugap, lavr, uavr, lspn, lmed, umed, num_minmax, num_avr, num_med, tot_gap, tot_spn, tot_avr);
 
 }
 
 
-void Popl_nodes(vector<Node*>* datab_m, vector<Pattern*>* dfs_q, int N, int L, int num_att,vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
+void Popl_nodes(Node_table* datab_m, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* dfs_q, int N, int L, int num_att,vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
 vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
 vector<int>* lgap, vector<int>* ugap, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed, 
-vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_gap, vector<int>* tot_spn, vector<int>* tot_avr) {	//this function decides to build an arc between two nodes pointed to by strp and endp. An arc is contructed if it does not violate any of the imposed constraints
+vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_gap, vector<int>* tot_spn, vector<int>* tot_avr) {
+
+	for (int i = 0; i < N; i++)
+		Popl_seq(datab_m, mr, lay, dfs_q, i, L, num_att, max_attrs, min_attrs, items, attrs, lgapi, ugapi, lspni, lmedi, umedi, lavri, uavri,
+			lgap, ugap, lavr, uavr, lspn, lmed, umed, num_minmax, num_avr, num_med, tot_gap, tot_spn, tot_avr);
+}
+
+
+void Popl_seq(Node_table* datab_m, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* dfs_q, int i, int L, int num_att,vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
+vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
+vector<int>* lgap, vector<int>* ugap, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed, 
+vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_gap, vector<int>* tot_spn, vector<int>* tot_avr) {	//adds the arcs of sequence i. this function decides to build an arc between two nodes pointed to by strp and endp. An arc is contructed if it does not violate any of the imposed constraints
 
 	bool antmon = 0;						//antimonotone property of contraints
-	for (int i = 0; i < N; i++) {
-		int endp = (*items)[i].size();				//endp initialized to last event in a sequence
-		int strp = endp - 1;					//strp initialized to one to last event in sequence
-		while (strp > 0) {
-			while (antmon == 0) {				//while antimonotone property of contraints is violated backtrack on endp
-			    // Original MPP repo uses abs(att[i] - att[i-1]) as the gap value. Here we remove abs().
-				if (!(*ugap).empty() && (*ugapi)[0] == 0 && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) > (*ugap)[0]) {		//antimonotone contraints are upper gap
-					endp--;
-					if (strp == endp) {
-						strp--;
-						if (strp == 0)
-							break;
-					}
-				}
-				else
-					antmon = 1;
-			}
-			if (antmon == 1) {				//while monotone property of constraints is satisfied add arc from strp to all nodes between strp and endp
-				int last_p = endp;
-				while (endp != strp) {
-				    // Original MPP repo uses abs(att[i] - att[i-1]) as the gap value. Here we remove abs().
-					if (!(*lgap).empty() && (*lgapi)[0] == 0 && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) < (*lgap)[0])
+	int endp = (*items)[i].size();				//endp initialized to last event in a sequence
+	int strp = endp - 1;					//strp initialized to one to last event in sequence
+	while (strp > 0) {
+		while (antmon == 0) {				//while antimonotone property of contraints is violated backtrack on endp
+		    // Original MPP repo uses abs(att[i] - att[i-1]) as the gap value. Here we remove abs().
+			if (!(*ugap).empty() && (*ugapi)[0] == 0 && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) > (*ugap)[0]) {		//antimonotone contraints are upper gap
+				endp--;
+				if (strp == endp) {
+					strp--;
+					if (strp == 0)
 						break;
-					//if (!(*lgap).empty() && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) > (*lgap)[0]) // because sorting is backwards?
-					//	break;
-					if ((*tot_gap).empty() || ((*tot_gap)[0] == 0 && (*tot_gap).size() == 1) || Check_gap(i ,strp, endp, attrs, lgapi, ugapi, lgap, ugap))
-						Add_arc(datab_m, dfs_q, i, strp, endp, L, num_att, max_attrs, min_attrs, items, attrs, lspni, lmedi, umedi, lavri, uavri, lavr, uavr, lspn, lmed, umed,
-							num_minmax, num_avr, num_med, tot_spn, tot_avr);
-					//else
-					//	break; // all future entries will also be further away - because we are in a sorted array
-					endp--;
 				}
-				strp--;
-				if (!(*ugap).empty())			//need to recheck wether antimonotone property is satisfied
-					antmon = 0;
-				endp = last_p;
 			}
+			else
+				antmon = 1;
+		}
+		if (antmon == 1) {				//while monotone property of constraints is satisfied add arc from strp to all nodes between strp and endp
+			int last_p = endp;
+			while (endp != strp) {
+			    // Original MPP repo uses abs(att[i] - att[i-1]) as the gap value. Here we remove abs().
+				if (!(*lgap).empty() && (*lgapi)[0] == 0 && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) < (*lgap)[0])
+					break;
+				//if (!(*lgap).empty() && (*attrs)[0].at(i).at(endp - 1) - (*attrs)[0].at(i).at(strp - 1) > (*lgap)[0]) // because sorting is backwards?
+				//	break;
+				if ((*tot_gap).empty() || ((*tot_gap)[0] == 0 && (*tot_gap).size() == 1) || Check_gap(i ,strp, endp, attrs, lgapi, ugapi, lgap, ugap))
+					Add_arc(datab_m, mr, lay, dfs_q, i, strp, endp, L, num_att, max_attrs, min_attrs, items, attrs, lspni, lmedi, umedi, lavri, uavri, lavr, uavr, lspn, lmed, umed,
+						num_minmax, num_avr, num_med, tot_spn, tot_avr);
+				//else
+				//	break; // all future entries will also be further away - because we are in a sorted array
+				endp--;
+			}
+			strp--;
+			if (!(*ugap).empty())			//need to recheck wether antimonotone property is satisfied
+				antmon = 0;
+			endp = last_p;
 		}
 	}
 }
@@ -127,34 +136,33 @@ vector<int>* lgap, vector<int>* ugap){	//checks upper and lower gap constraints
 }
 
 
-void Add_arc(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue, int ID, int strp, int endp, int L, int num_att, vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
+void Add_arc(Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* DFS_queue, int ID, int strp, int endp, int L, int num_att, vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
 vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* lmed, vector<int>* umed, 
 vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr) {						//Adds an arc from strp node to endp node
 
-	int fnod = (*items)[ID].at(strp - 1) + (strp - 1) * L;
-	int tnod = (*items)[ID].at(endp - 1) + (endp - 1) * L;
-
-	Intlz_node(fnod - 1, datab_MDD);
-	Intlz_node(tnod - 1, datab_MDD);
+	Node* fnod = Intlz_node(Node_key(strp, (*items)[ID].at(strp - 1), L), datab_MDD, mr, lay);
+	Node* tnod = Intlz_node(Node_key(endp, (*items)[ID].at(endp - 1), L), datab_MDD, mr, lay);
 
-	(*datab_MDD)[tnod - 1]->assign_ID(ID + 1, endp, NULL, lspni, lmedi, umedi, lavri, uavri,
+	tnod->assign_ID(ID + 1, endp, NULL, lspni, lmedi, umedi, lavri, uavri,
 	lavr, uavr, lmed, umed,
-	num_minmax, num_avr, num_med, tot_spn, tot_avr, num_att, max_attrs, min_attrs, items, attrs);				//stores in MDD node the required information for constraint satisfaction in mining algorithm
-	(*datab_MDD)[fnod - 1]->assign_ID(ID + 1, strp, (*datab_MDD)[tnod - 1], lspni, lmedi, umedi, lavri, uavri,
+	num_minmax, num_avr, num_med, num_att, max_attrs, min_attrs, items, attrs);				//stores in MDD node the required information for constraint satisfaction in mining algorithm
+	fnod->assign_ID(ID + 1, strp, tnod, lspni, lmedi, umedi, lavri, uavri,
 	lavr, uavr, lmed, umed, 
-	num_minmax, num_avr, num_med, tot_spn, tot_avr, num_att, max_attrs, min_attrs, items, attrs);
+	num_minmax, num_avr, num_med, num_att, max_attrs, min_attrs, items, attrs);
 
-	Intlz_DFS(DFS_queue, ID, (*datab_MDD)[fnod - 1], (*datab_MDD)[tnod - 1], max_attrs, min_attrs, lspni, lmedi, umedi, lavri, uavri, lavr, uavr, lspn, lmed, umed,
+	Intlz_DFS(DFS_queue, ID, fnod, tnod, max_attrs, min_attrs, lspni, lmedi, umedi, lavri, uavri, lavr, uavr, lspn, lmed, umed,
 	num_minmax, num_avr, num_med, tot_spn, tot_avr);			//Adds pointer as starting point for mining algorithm
 }
 
 
-void Intlz_node(int nod, vector<Node*>* datab_MDD) {
-	if ((*datab_MDD)[nod] == NULL) {
-		(*datab_MDD)[nod] = new Node();
-		(*datab_MDD)[nod]->ID = nod + 1;
+Node* Intlz_node(int64_t nod, Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay) {
+	Node*& node = (*datab_MDD)[nod];
+	if (node == NULL) {
+		node = Arena_new<Node>(mr, lay);
+		node->ID = nod;
 	}
+	return node;
 }
 
 
@@ -166,39 +174,39 @@ vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>
 	if (fnod->parent != ID + 1){
 		int att_pos = 0;
 		for (vector<int>::iterator it = (*lspni).begin(); it != (*lspni).end(); it++){
-			if (fnod->attr.back()->at(*it)->at(2) - fnod->attr.back()->at(*it)->at(1) < (*lspn)[att_pos]) 
+			if (fnod->last_att(*it)[2] - fnod->last_att(*it)[1] < (*lspn)[att_pos]) 
 				return;
 			att_pos++;
 		}
 
 		att_pos = 0;
 		for (vector<int>::iterator it = (*lavri).begin(); it != (*lavri).end(); it++){
-			if ((double)(fnod->attr.back()->at(*it)->at(0) + tnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it])) / 
-				(1 + tnod->attr.back()->at(*it)->at((*num_minmax)[*it] + 2 * (*num_avr)[*it])) < (*lavr)[att_pos]) 
+			if ((double)(fnod->last_att(*it)[0] + tnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it]]) / 
+				(1 + tnod->last_att(*it)[(*num_minmax)[*it] + 2 * (*num_avr)[*it]]) < (*lavr)[att_pos]) 
 				return;
 			att_pos++;
 		}
 
 		att_pos = 0;
 		for (vector<int>::iterator it = (*uavri).begin(); it != (*uavri).end(); it++){
-			if ((double)(fnod->attr.back()->at(*it)->at(0) + tnod->attr.back()->at(*it)->at((*num_minmax)[*it] + 1)) / 
-				(1 + tnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] + 1)) > (*uavr)[att_pos]) 
+			if ((double)(fnod->last_att(*it)[0] + tnod->last_att(*it)[(*num_minmax)[*it] + 1]) / 
+				(1 + tnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] + 1]) > (*uavr)[att_pos]) 
 				return;
 			att_pos++;
 		}
 
 		att_pos = 0;
 		for (vector<int>::iterator it = (*umedi).begin(); it != (*umedi).end(); it++){
-			if (fnod->attr.back()->at(*it)->at(0) > (*umed)[att_pos]){
-				if (-1 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 1) < 0) 
+			if (fnod->last_att(*it)[0] > (*umed)[att_pos]){
+				if (-1 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 1] < 0) 
 					return;
-				else if (-1 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 1) == 0){
+				else if (-1 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 1] == 0){
 					int fnod3;
-					if (fnod->attr.back()->at(*it)->at(0) < fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 3))
-						fnod3 = fnod->attr.back()->at(*it)->at(0);
+					if (fnod->last_att(*it)[0] < fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 3])
+						fnod3 = fnod->last_att(*it)[0];
 					else
-						fnod3 = fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 3);
-					if (0.5 * (fnod3 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 2)) > (*umed)[att_pos])
+						fnod3 = fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 3];
+					if (0.5 * (fnod3 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + ((*num_med)[*it] - 1) * 3 + 2]) > (*umed)[att_pos])
 						return;
 				}
 			}
@@ -207,16 +215,16 @@ vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>
 
 		att_pos = 0;
 		for (vector<int>::iterator it = (*lmedi).begin(); it != (*lmedi).end(); it++){
-			if (fnod->attr.back()->at(*it)->at(0) < (*lmed)[att_pos]){
-				if (-1 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + 1) < 0) 
+			if (fnod->last_att(*it)[0] < (*lmed)[att_pos]){
+				if (-1 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + 1] < 0) 
 					return;
-				else if (-1 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + 1) == 0){
+				else if (-1 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + 1] == 0){
 					int fnod2;
-					if (fnod->attr.back()->at(*it)->at(0) > fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + 2))
-						fnod2 = fnod->attr.back()->at(*it)->at(0);
+					if (fnod->last_att(*it)[0] > fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + 2])
+						fnod2 = fnod->last_att(*it)[0];
 					else
-						fnod2 = fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + 2);
-					if (0.5 * (fnod2 + fnod->attr.back()->at(*it)->at((*num_minmax)[*it] + (*num_avr)[*it] * 2 + 3)) < (*lmed)[att_pos])
+						fnod2 = fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + 2];
+					if (0.5 * (fnod2 + fnod->last_att(*it)[(*num_minmax)[*it] + (*num_avr)[*it] * 2 + 3]) < (*lmed)[att_pos])
 						return;
 				}
 			}
@@ -226,56 +234,47 @@ vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>
 
 
 		if ((*DFS_queue)[fnod->item - 1] == NULL) {
-			(*DFS_queue)[fnod->item - 1] = new Pattern();
-			(*DFS_queue)[fnod->item - 1]->Update(ID + 1, umedi,  lmedi, tot_spn, tot_avr);
+			(*DFS_queue)[fnod->item - 1] = Arena_new<Pattern>(fnod->mr, fnod->lay);
+			(*DFS_queue)[fnod->item - 1]->Update(ID + 1);
 			(*DFS_queue)[fnod->item - 1]->patt_seq.push_back(fnod->item);
 		}
 
 		if ((*DFS_queue)[fnod->item - 1]->seq_ID.back() != ID + 1)
-			(*DFS_queue)[fnod->item - 1]->Update(ID + 1, umedi,  lmedi, tot_spn, tot_avr);
+			(*DFS_queue)[fnod->item - 1]->Update(ID + 1);
 
-		(*DFS_queue)[fnod->item - 1]->str_pnt.back()->push_back(fnod);
+		int* rec = (*DFS_queue)[fnod->item - 1]->add_pnt(fnod);
+		const Attr_layout* lay = fnod->lay;
 
 		for (int i = 0; i < (*tot_spn).size(); i++) {
-			if ((*DFS_queue)[fnod->item - 1]->spn.back()->size() < (*tot_spn).size())
-				(*DFS_queue)[fnod->item - 1]->spn.back()->push_back(new vector<vector<int>*>);
-			(*DFS_queue)[fnod->item - 1]->spn.back()->at(i)->push_back(new vector<int>(2, fnod->attr.back()->at((*tot_spn)[i])->at(0)));
-		}
-		for (int i = 0; i < (*tot_avr).size(); i++){
-			if ((*DFS_queue)[fnod->item - 1]->avr.back()->size() < (*tot_avr).size())
-				(*DFS_queue)[fnod->item - 1]->avr.back()->push_back(new vector<int>);
-			(*DFS_queue)[fnod->item - 1]->avr.back()->at(i)->push_back(fnod->attr.back()->at((*tot_avr)[i])->at(0));
+			lay->spn(rec, i)[0] = fnod->last_att((*tot_spn)[i])[0];
+			lay->spn(rec, i)[1] = fnod->last_att((*tot_spn)[i])[0];
 		}
+		for (int i = 0; i < (*tot_avr).size(); i++)
+			lay->avr(rec, i)[0] = fnod->last_att((*tot_avr)[i])[0];
 
 		for (int i = 0; i < (*lmedi).size(); i++){
-			if ((*DFS_queue)[fnod->item - 1]->lmed.back()->size() < (*lmedi).size())
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->push_back(new vector<vector<int>*>);
-			(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->push_back(new vector<int>(3));
-			if (fnod->attr.back()->at((*lmedi)[i])->at(0) < (*lmed)[i]){
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(0) = -1;
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(1) = fnod->attr.back()->at((*lmedi)[i])->at(0);
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(2) = (*max_attrs)[(*lmedi)[i]] + 1;
+			if (fnod->last_att((*lmedi)[i])[0] < (*lmed)[i]){
+				lay->lmed(rec, i)[0] = -1;
+				lay->lmed(rec, i)[1] = fnod->last_att((*lmedi)[i])[0];
+				lay->lmed(rec, i)[2] = (*max_attrs)[(*lmedi)[i]] + 1;
 			}
 			else {
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(0) = 1;
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(1) = (*min_attrs)[(*lmedi)[i]] - 1;
-				(*DFS_queue)[fnod->item - 1]->lmed.back()->at(i)->back()->at(2) = fnod->attr.back()->at((*lmedi)[i])->at(0);
+				lay->lmed(rec, i)[0] = 1;
+				lay->lmed(rec, i)[1] = (*min_attrs)[(*lmedi)[i]] - 1;
+				lay->lmed(rec, i)[2] = fnod->last_att((*lmedi)[i])[0];
 			}
 		}
 
 		for (int i = 0; i < (*umedi).size(); i++){
-			if ((*DFS_queue)[fnod->item - 1]->umed.back()->size() < (*umedi).size())
-				(*DFS_queue)[fnod->item - 1]->umed.back()->push_back(new vector<vector<int>*>);
-			(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->push_back(new vector<int>(3));
-			if (fnod->attr.back()->at((*umedi)[i])->at(0) <= (*umed)[i]){
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(0) = 1;
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(1) = fnod->attr.back()->at((*umedi)[i])->at(0);
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(2) = (*max_attrs)[(*umedi)[i]] + 1;
+			if (fnod->last_att((*umedi)[i])[0] <= (*umed)[i]){
+				lay->umed(rec, i)[0] = 1;
+				lay->umed(rec, i)[1] = fnod->last_att((*umedi)[i])[0];
+				lay->umed(rec, i)[2] = (*max_attrs)[(*umedi)[i]] + 1;
 			}
 			else {
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(0) = -1;
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(1) = (*min_attrs)[(*umedi)[i]] - 1;
-				(*DFS_queue)[fnod->item - 1]->umed.back()->at(i)->back()->at(2) = fnod->attr.back()->at((*umedi)[i])->at(0);
+				lay->umed(rec, i)[0] = -1;
+				lay->umed(rec, i)[1] = (*min_attrs)[(*umedi)[i]] - 1;
+				lay->umed(rec, i)[2] = fnod->last_att((*umedi)[i])[0];
 			}
 		}
 
@@ -283,3 +282,39 @@ vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>
 	}
 
 }
+
+
+void Remove_seq(Node_table* datab_MDD, pmr::memory_resource* mr, vector<Pattern*>* DFS_queue, int ID, int L, vector<int>* seq_items) {	//takes the arcs of sequence ID (i + 1 in Popl_seq) out of the MDD again
+	for (int lvl = 1; lvl <= (*seq_items).size(); lvl++) {
+		Node_table::iterator it = (*datab_MDD).find(Node_key(lvl, (*seq_items)[lvl - 1], L));
+		if (it == (*datab_MDD).end())
+			continue;
+		Node* nod = it->second;
+		int pos = find_ID(ID, &nod->seq_ID);
+		if (pos == -1)						//no arc to or from this event
+			continue;
+		nod->seq_ID.erase(nod->seq_ID.begin() + pos);
+		Arena_delete(mr, nod->children[pos]);
+		nod->children.erase(nod->children.begin() + pos);
+		if (nod->lay->att_stride > 0)
+			nod->attr.erase(nod->attr.begin() + (size_t)pos * nod->lay->att_stride, nod->attr.begin() + (size_t)(pos + 1) * nod->lay->att_stride);
+		if (nod->seq_ID.empty()) {
+			(*datab_MDD).erase(it);
+			Arena_delete(mr, nod);
+		}
+	}
+
+	for (int lvl = 1; lvl <= (*seq_items).size(); lvl++) {
+		Pattern*& patt = (*DFS_queue)[(*seq_items)[lvl - 1] - 1];
+		if (patt == NULL)
+			continue;
+		int pos = find_ID(ID, &patt->seq_ID);
+		if (pos == -1)						//not a start point or already taken out (item repeats in the sequence)
+			continue;
+		patt->Remove(pos);
+		if (patt->seq_ID.empty()) {
+			Free_patt(patt);
+			patt = NULL;
+		}
+	}
+}
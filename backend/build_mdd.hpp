@@ -10,7 +10,7 @@
 #include <cmath>
 
 
-void Build_MDD(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue,
+void Build_MDD(Node_table* datab_MDD, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* DFS_queue,
                             vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni,
                             vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, vector<int>* lmedi,
                             vector<int>* lgap, vector<int>* ugap, vector<int>* lavr, vector<int>* uavr,
@@ -21,6 +21,30 @@ void Build_MDD(vector<Node*>* datab_MDD, vector<Pattern*>* DFS_queue,
                             vector<int>* min_attrs, vector<vector<int> >* items,
                             vector<vector<vector<int> > >* attrs);
 
+// Adds the arcs of sequence i (of items and attrs) to the MDD, Build_MDD does this for every sequence
+void Popl_seq(Node_table* datab_m, pmr::memory_resource* mr, const Attr_layout* lay, vector<Pattern*>* dfs_q, int i, int L, int num_att,
+                            vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs,
+                            vector<int>* lgapi, vector<int>* ugapi, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi,
+                            vector<int>* lavri, vector<int>* uavri,
+                            vector<int>* lgap, vector<int>* ugap, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn,
+                            vector<int>* lmed, vector<int>* umed,
+                            vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_gap,
+                            vector<int>* tot_spn, vector<int>* tot_avr);
+
+// Takes sequence ID (i + 1) out of the MDD and the initial patterns again, nodes without sequences are deleted.
+// seq_items are the items the sequence was added with.
+void Remove_seq(Node_table* datab_MDD, pmr::memory_resource* mr, vector<Pattern*>* DFS_queue, int ID, int L, vector<int>* seq_items);
+
+// MDD that is kept between mining runs (sliding windows). Sequences are added with Popl_seq and taken out with
+// Remove_seq. Everything lives in arena, memory of removed sequences comes back only with the Mdd_db (start
+// a new one after many sequences were removed, a pool is much slower to build into).
+struct Mdd_db {
+	pmr::monotonic_buffer_resource arena;
+	Node_table nodes;
+	Attr_layout lay;
+	vector<Pattern*> dfs_q;					//initial patterns, one per item. Mining frees patterns, it gets copies.
+};
+
 void Disp_nodes(int, int);
 
 
@@ -4,78 +4,282 @@
 //Freq_miner() function: mines all frequent patterns in the MDD database 
 
 #include "freq_miner.hpp"
+#include <algorithm>
+#include <mutex>
+#include <tbb/task_group.h>
+#include <tbb/enumerable_thread_specific.h>
 // #include <iostream>
 // #include <time.h>
 
-void Extend_patt(Pattern*,  int theta, int L, vector<Pattern*>* dfs_q,
+// Cons: the mining run has span, average or median constraints. Without them (LoCo only uses a gap constraint, which is
+// handled when the MDD is built) Find_items is compiled without the constraint checks and the information they need.
+template <bool Cons>
+void Extend_patt(Mine_ctx* ctx, Pattern*,  int theta, int L, vector<Pattern*>* dfs_q,
 vector<int>* umedi, vector<int>* lmedi, vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri,
 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med);	//Extends a pattern by one event
 
-void Find_items(int ID, Pattern* _patt, vector<Pattern*>* pot_patt, vector<int>* item_count, int theta, vector<int>* umedi, vector<int>* lmedi,
+template <bool Cons>
+void Find_items(Mine_ctx* ctx, int ID, Pattern* _patt, vector<Pattern*>* pot_patt, vector<int>* item_count, int theta, vector<int>* umedi, vector<int>* lmedi,
 vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, 
 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med);		//Finds number patterns of the form <_patt,event> in the database, for all event types
 
-int Check_cons(int ID, int par_pos, Node* tnod, Pattern* _patt, vector<int>* umedi, vector<int>* lmedi,
+int Check_cons(Mine_ctx* ctx, int ID, int par_pos, Node* tnod, Pattern* _patt, vector<int>* umedi, vector<int>* lmedi,
 vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, 
 vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med);					//Checks satisfcation of constraints during mining algorithm
 
-int find_ID(int ID, vector<int>* vec);
-
-vector<bool> indic_vec;
-vector<vector<int>> result;
-int num_max_patt;
-int iter;
-int chil_ID_pos;
 double mm=0;
 
 // Changed signature
-vector<vector<int>> Freq_miner(vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+int Freq_miner(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
 	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed,
-	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L, int max_number_of_pattern = -1) {
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L, int max_number_of_pattern) {
 
 //	Clear the elements in result and shrink the vector's capacity to 0
-    result.clear();
-    result.shrink_to_fit();
+    ctx->result.clear();
+    ctx->result.shrink_to_fit();
+	ctx->num_max_patt = 0;
+	ctx->stop = false;
+	ctx->interrupted = false;
+	int steps = 0;
+
+	bool cons = !(*tot_spn).empty() || !(*tot_avr).empty() || !(*lmedi).empty() || !(*umedi).empty();
+	auto extend = cons ? Extend_patt<true> : Extend_patt<false>;
+	int top_theta = theta;
 
 	while (! (*dfs_q).empty()) {								//takes pattern out from last input to DFS queue and searches for its extension by possible events
-		if ( (*dfs_q).back() != NULL &&  (*dfs_q).back()->freq >= theta)
-			Extend_patt( (*dfs_q).back(), theta, L, dfs_q, 
+		if (ctx->top != NULL)									//top-k: patterns below the k best found so far are not needed
+			top_theta = std::max(theta, ctx->top->theta.load(std::memory_order_relaxed));
+		if ( (*dfs_q).back() != NULL &&  (*dfs_q).back()->freq >= top_theta)
+			extend(ctx, (*dfs_q).back(), top_theta, L, dfs_q, 
 				umedi, lmedi, tot_spn, tot_avr, uspni, lspni, uavri, lavri, lavr, uavr, lspn, uspn, lmed, umed, num_minmax, num_avr, num_med);
 		else {
 			if ( (*dfs_q).back()!=NULL)
-				 (*dfs_q).back()->~Pattern();
+				Free_patt((*dfs_q).back());
 			 (*dfs_q).pop_back();
 		}
-		if (max_number_of_pattern > 0 && result.size() > max_number_of_pattern) // too many pattern, give up here
+		if (max_number_of_pattern > 0 && ctx->num_max_patt > max_number_of_pattern) // too many pattern, give up here
+			break;
+		if (ctx->stop) // the sink does not want more
+			break;
+		if ((++steps & 63) == 0 && Out_of_time(ctx)) { // cancelled or out of time, keep what we have
+			ctx->interrupted = true;
+			break;
+		}
+		if (ctx->cutoff != NULL && ctx->order > ctx->cutoff->load(std::memory_order_relaxed)) // earlier subtrees found enough pattern
+			break;
+	}
+
+	return ctx->num_max_patt;
+}
+
+
+// Serial order of the roots, if frequent is set the most frequent ones first (same frequency: serial order)
+static vector<int> Top_order(vector<Pattern*>* roots, bool frequent) {
+	vector<int> order((*roots).size());
+	for (int i = 0; i < order.size(); i++)
+		order[i] = i;
+	if (frequent)
+		stable_sort(order.begin(), order.end(), [roots](int a, int b) {
+			int fa = (*roots)[a] != NULL ? (*roots)[a]->freq : -1;
+			int fb = (*roots)[b] != NULL ? (*roots)[b]->freq : -1;
+			return fa > fb;
+		});
+	return order;
+}
+
+
+int Freq_miner_top(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed,
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L) {
+
+	int num_sub = (*dfs_q).size();
+	vector<Pattern*> roots(num_sub);
+	for (int k = 0; k < num_sub; k++)
+		roots[num_sub - 1 - k] = (*dfs_q)[k];
+	(*dfs_q).clear();
+	bool interrupted = false;
+	for (int order : Top_order(&roots, true)) {
+		if (roots[order] == NULL)
+			continue;
+		ctx->order = order;
+		vector<Pattern*> sub_q(1, roots[order]);
+		Freq_miner(ctx, &sub_q, uspni, lspni, uavri, lavri, umedi, lmedi, lavr, uavr, lspn, uspn, lmed, umed,
+			num_minmax, num_avr, num_med, tot_spn, tot_avr, theta, L, 0);
+		if (ctx->interrupted) {			//the rest of the patterns go with the arena
+			interrupted = true;
 			break;
+		}
+	}
+	ctx->interrupted = interrupted;
+	return ctx->top->heap.size();
+}
+
+
+int Freq_miner_parallel(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed,
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L, int max_number_of_pattern) {
+
+	// Freq_miner takes patterns from the back of dfs_q, every initial pattern is the root of an independent subtree.
+	// order is the position in which Freq_miner would have mined a subtree. Tasks take the next subtree in that
+	// order when they start, so the subtrees we need first are mined first.
+	int num_sub = (*dfs_q).size();
+	vector<Pattern*> roots(num_sub);
+	for (int k = 0; k < num_sub; k++)
+		roots[num_sub - 1 - k] = (*dfs_q)[k];
+	vector<vector<vector<int>>> sub_result(num_sub);
+	vector<int> sub_done(num_sub, -1);			//number of patterns found in a finished subtree
+	std::atomic<int> cutoff(num_sub);				//subtrees after this one are not needed anymore
+	std::atomic<int> next_order(0);
+	std::mutex done_lock;
+	int flushed = 0;							//subtrees handed to the sink, in serial order
+	int delivered = 0;							//patterns handed to the sink
+	bool stopped = false;
+	Patt_sink* sink = ctx->sink;
+	ctx->interrupted = false;
+	tbb::enumerable_thread_specific<Mine_ctx> thread_ctx;	//one context per thread, its scratch buffers are reused for every subtree the thread mines
+	vector<int> by_freq = Top_order(&roots, ctx->top != NULL);	//top-k: frequent subtrees first, theta goes up sooner
+
+	// called with done_lock held when a subtree is finished
+	auto finish = [&](int order, int found_here) {
+		sub_done[order] = found_here;
+		// if the subtrees up to here (in serial order) have enough patterns the ones after them can stop
+		if (max_number_of_pattern > 0) {
+			int found = 0;
+			for (int i = 0; i < num_sub && sub_done[i] >= 0; i++) {
+				found += sub_done[i];
+				if (found > max_number_of_pattern) {
+					if (i < cutoff.load())
+						cutoff.store(i);
+					break;
+				}
+			}
+		}
+		// hand the finished prefix to the sink, as many patterns as the serial version would have found
+		for (; flushed < num_sub && sub_done[flushed] >= 0 && !stopped; flushed++) {
+			for (int j = 0; j < sub_result[flushed].size() && !stopped; j++) {
+				if (max_number_of_pattern > 0 && delivered > max_number_of_pattern)
+					stopped = true;
+				else if (!(*sink)(sub_result[flushed][j]))
+					stopped = true;
+				else
+					delivered++;
+			}
+			vector<vector<int>>().swap(sub_result[flushed]);
+			if (stopped && flushed < cutoff.load())
+				cutoff.store(flushed);
+		}
+	};
+
+	tbb::task_group tg;
+	for (int k = 0; k < num_sub; k++) {
+		tg.run([&]() {
+			int order = by_freq[next_order++];
+			Pattern* root = roots[order];
+			int top_theta = (ctx->top != NULL) ? std::max(theta, ctx->top->theta.load(std::memory_order_relaxed)) : theta;
+			bool late = root != NULL && root->freq >= top_theta && Out_of_time(ctx);
+			if (root == NULL || root->freq < top_theta || order > cutoff.load(std::memory_order_relaxed) || late) {
+				if (root != NULL)
+					Free_patt(root);
+				std::lock_guard<std::mutex> guard(done_lock);
+				if (late)
+					ctx->interrupted = true;
+				finish(order, 0);
+				return;
+			}
+			Mine_ctx& sub_ctx = thread_ctx.local();
+			sub_ctx.cutoff = &cutoff;
+			sub_ctx.order = order;
+			sub_ctx.cancel = ctx->cancel;
+			sub_ctx.deadline = ctx->deadline;
+			sub_ctx.top = ctx->top;
+			vector<Pattern*> sub_q(1, root);
+			// each subtree stops on its own after max_number_of_pattern + 1 patterns, same as the serial version
+			Freq_miner(&sub_ctx, &sub_q, uspni, lspni, uavri, lavri, umedi, lmedi, lavr, uavr, lspn, uspn, lmed, umed,
+				num_minmax, num_avr, num_med, tot_spn, tot_avr, theta, L, max_number_of_pattern);
+
+			std::lock_guard<std::mutex> guard(done_lock);
+			if (sub_ctx.interrupted)
+				ctx->interrupted = true;
+			sub_result[order].swap(sub_ctx.result);
+			finish(order, sub_result[order].size());
+		});
 	}
+	tg.wait();
+	(*dfs_q).clear();
+
+	return delivered;
+}
+
 
-	return result;
+// patterns with larger frequency first, then the one found first by the serial miner
+static bool Better(const Top_k::Entry& a, const Top_k::Entry& b) {
+	if (a.patt.back() != b.patt.back())
+		return a.patt.back() > b.patt.back();
+	if (a.order != b.order)
+		return a.order < b.order;
+	return a.index < b.index;
 }
 
+void Top_k::Offer(const vector<int>& patt, int order, int index) {
+	if (patt.back() < theta.load(std::memory_order_relaxed))
+		return;
+	std::lock_guard<std::mutex> guard(lock);
+	Entry entry = { patt, order, index };
+	if ((int)heap.size() < k) {
+		heap.push_back(std::move(entry));
+		push_heap(heap.begin(), heap.end(), Better);
+	}
+	else if (Better(entry, heap.front())) {
+		pop_heap(heap.begin(), heap.end(), Better);
+		heap.back() = std::move(entry);
+		push_heap(heap.begin(), heap.end(), Better);
+	}
+	else
+		return;
+	if ((int)heap.size() == k && heap.front().patt.back() > theta.load())		//equal frequency can still win if found earlier in serial order
+		theta.store(heap.front().patt.back());
+}
 
-void Extend_patt(Pattern* _patt, int theta, int L, vector<Pattern*>* dfs_q,
+int Top_k::Flush(Patt_sink* sink) {
+	sort(heap.begin(), heap.end(), Better);
+	int delivered = 0;
+	for (int i = 0; i < heap.size(); i++) {
+		if (!(*sink)(heap[i].patt))
+			break;
+		delivered++;
+	}
+	vector<Entry>().swap(heap);
+	return delivered;
+}
+
+
+template <bool Cons>
+void Extend_patt(Mine_ctx* ctx, Pattern* _patt, int theta, int L, vector<Pattern*>* dfs_q,
 vector<int>* umedi, vector<int>* lmedi, vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri,
 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med) {			//Extends _patt by any possible event types
 
 	 (*dfs_q).pop_back();
 
-	indic_vec = vector<bool>(L, 1);
-	vector<int> item_count(L, 0);
-	iter = 0;										//position at which the str_pnt vector of ID under consideration is stored at parent node 
-
-	vector<Pattern*> pot_patt(L, NULL);
+	if (ctx->indic_vec.size() < L) {							//scratch buffers per event type, allocated once per run, Find_items lists the ones it changes in touched
+		ctx->indic_vec.assign(L, 1);
+		ctx->item_count.assign(L, 0);
+		ctx->pot_patt.assign(L, NULL);
+	}
+	vector<int>& item_count = ctx->item_count;
+	vector<Pattern*>& pot_patt = ctx->pot_patt;
+	ctx->iter = 0;										//position at which the str_pnt vector of ID under consideration is stored at parent node 
 
-	for (int i = 0; i < _patt->str_pnt.size(); i++) {
-		Find_items(_patt->seq_ID[i] - 1, _patt, &pot_patt, &item_count, theta, umedi, lmedi, tot_spn, tot_avr, 
+	for (int i = 0; i < _patt->seq_ID.size(); i++) {
+		Find_items<Cons>(ctx, _patt->seq_ID[i] - 1, _patt, &pot_patt, &item_count, theta, umedi, lmedi, tot_spn, tot_avr, 
 		uspni, lspni, uavri, lavri, lavr, uavr, lspn, uspn, lmed, umed, num_minmax, num_avr, num_med);		//finds number of patterns per L (number of event types) possible extensions of _patt
-		iter++;
+		ctx->iter++;
 
 	}
 
 
 	int all = 0;
-	for (int i = 0; i < L; i++) {								//For every possible extension checks frequency threshold, if satisfied adds new patter to DFS queue
+	sort(ctx->touched.begin(), ctx->touched.end());				//same order as a scan over all event types
+	for (int i : ctx->touched) {								//For every possible extension checks frequency threshold, if satisfied adds new patter to DFS queue
 		if (item_count[i] >= theta) {
 			pot_patt[i]->patt_seq = _patt->patt_seq;
 			pot_patt[i]->patt_seq.push_back(i + 1);
@@ -86,28 +290,40 @@ vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vect
 			all++;
 		}
 		else if (pot_patt[i] != NULL && pot_patt[i]!=0)
-			pot_patt[i]->~Pattern();
+			Free_patt(pot_patt[i]);
+		ctx->indic_vec[i] = 1;
+		item_count[i] = 0;
+		pot_patt[i] = NULL;
 	}
+	ctx->touched.clear();
 
 	if (_patt->patt_seq.size() > 1 && _patt->act_freq >= theta) {				//A maximal pattern (cannot be extended further by any event)
-		num_max_patt++;
-
 		(&_patt->patt_seq)->push_back(_patt->act_freq);
-		vector<int> temp = *(&_patt->patt_seq);
-		result.push_back(temp);
+		vector<int> temp(_patt->patt_seq.begin(), _patt->patt_seq.end());
+		if (ctx->top != NULL)
+			ctx->top->Offer(temp, ctx->order, ctx->num_max_patt);
+		else if (ctx->sink == NULL)
+			ctx->result.push_back(temp);
+		else if (!(*ctx->sink)(temp))
+			ctx->stop = true;
+		if (!ctx->stop)
+			ctx->num_max_patt++;
 	}
-	_patt->~Pattern();
+	Free_patt(_patt);
 }
 
 
-void Find_items(int ID, Pattern* _patt, vector<Pattern*>* pot_patt, vector<int>* item_count, int theta,
+template <bool Cons>
+void Find_items(Mine_ctx* ctx, int ID, Pattern* _patt, vector<Pattern*>* pot_patt, vector<int>* item_count, int theta,
 vector<int>* umedi, vector<int>* lmedi, vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, 
 vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr,
 vector<int>* num_med) {			//Find extensions by searching children of MDD nodes
 
-	int par_pos = _patt->str_pnt[iter]->size();	//position of parent in str_pnt[iter] vector (back_tracking on parent vector due to bottom-up MDD construction)
+	int par_pos = _patt->num_pnt(ctx->iter);	//position of parent in the start pointers of seq iter (back_tracking on parent vector due to bottom-up MDD construction)
+	Node_list::iterator first = _patt->str_pnt.begin() + _patt->seq_begin[ctx->iter];
+	const Attr_layout* lay = _patt->lay;
 
-	for (vector<Node*>::reverse_iterator it1 = _patt->str_pnt[iter]->rbegin(); it1 != _patt->str_pnt[iter]->rend(); it1++) {
+	for (Node_list::reverse_iterator it1(first + par_pos); it1 != Node_list::reverse_iterator(first); it1++) {
 
 		par_pos--;
 		int ID_pos = find_ID(ID + 1, &(*it1)->seq_ID);							//position of ID in parent vector (used to get position of relevent children, time, skip, etc., vectors)
@@ -115,35 +331,38 @@ vector<int>* num_med) {			//Find extensions by searching children of MDD nodes
 			continue;
 
 		int chil_pos = (*it1)->children[ID_pos]->size()-1;						//position of child in children vector 
-		for (vector<Node*>::reverse_iterator it2 = (*it1)->children[ID_pos]->rbegin(); it2 != (*it1)->children[ID_pos]->rend(); it2++) {
+		for (Node_list::reverse_iterator it2 = (*it1)->children[ID_pos]->rbegin(); it2 != (*it1)->children[ID_pos]->rend(); it2++) {
 
 
-			if (indic_vec[(*it2)->item - 1] == 0)
+			if (ctx->indic_vec[(*it2)->item - 1] == 0)
 				continue;
 
 			int cond = 1;
-			if (!(*tot_spn).empty() || !(*tot_avr).empty() || !(*lmedi).empty() || !(*umedi).empty()) {		//constraint check
-				cond = Check_cons(ID, par_pos, *it2, _patt, umedi, lmedi, uspni, lspni, uavri, lavri, lavr, uavr, lspn, uspn, lmed, umed, num_minmax, num_avr, num_med);
+			if constexpr (Cons) {		//constraint check
+				cond = Check_cons(ctx, ID, par_pos, *it2, _patt, umedi, lmedi, uspni, lspni, uavri, lavri, lavr, uavr, lspn, uspn, lmed, umed, num_minmax, num_avr, num_med);
 				if (cond == -1)
 					break;
 				else if (cond == 0)
 					continue;
 			}
 
-			if (iter - (*item_count)[(*it2)->item - 1] > _patt->freq - theta) {			//rest of code corresponds to information generation and storing for constraint satisfaction
-				indic_vec[(*it2)->item - 1] = 0;
+			if (ctx->iter - (*item_count)[(*it2)->item - 1] > _patt->freq - theta) {			//rest of code corresponds to information generation and storing for constraint satisfaction
+				ctx->indic_vec[(*it2)->item - 1] = 0;
+				if ((*pot_patt)[(*it2)->item - 1] == NULL)
+					ctx->touched.push_back((*it2)->item - 1);
 				continue;
 			}
 			
 
 			if ((*pot_patt)[(*it2)->item - 1] == NULL) {
-				(*pot_patt)[(*it2)->item - 1] = new Pattern(); // somehow this does not get freed here... but there is a swap in pattern.hpp
-				(*pot_patt)[(*it2)->item - 1]->Update(ID + 1, umedi, lmedi, tot_spn, tot_avr);
+				(*pot_patt)[(*it2)->item - 1] = Arena_new<Pattern>(ctx->mr, lay);
+				ctx->touched.push_back((*it2)->item - 1);
+				(*pot_patt)[(*it2)->item - 1]->Update(ID + 1);
 				(*item_count)[(*it2)->item - 1]++;
 			}
 
 			if ((*pot_patt)[(*it2)->item - 1]->seq_ID.back() != ID + 1) {
-				(*pot_patt)[(*it2)->item - 1]->Update(ID + 1, umedi, lmedi, tot_spn, tot_avr);
+				(*pot_patt)[(*it2)->item - 1]->Update(ID + 1);
 				(*item_count)[(*it2)->item - 1]++;
 			}
 
@@ -152,97 +371,91 @@ vector<int>* num_med) {			//Find extensions by searching children of MDD nodes
 				(*pot_patt)[(*it2)->item - 1]->act_freq++;
 			}
 			
-                    	(*pot_patt)[(*it2)->item - 1]->str_pnt.back()->push_back((*it2));
-
-			for (int i = 0; i < (*tot_spn).size(); i++) {
-				if ((*pot_patt)[(*it2)->item - 1]->spn.back()->size() < (*tot_spn).size())
-					(*pot_patt)[(*it2)->item - 1]->spn.back()->push_back(new vector<vector<int>*>);
-				(*pot_patt)[(*it2)->item - 1]->spn.back()->at(i)->push_back(new vector<int>(2));
-				if ((*it2)->attr[chil_ID_pos]->at((*tot_spn)[i])->at(0) < _patt->spn[iter]->at(i)->at(par_pos)->at(0))
-					(*pot_patt)[(*it2)->item - 1]->spn.back()->at(i)->back()->at(0) = (*it2)->attr[chil_ID_pos]->at((*tot_spn)[i])->at(0);
-				else
-					(*pot_patt)[(*it2)->item - 1]->spn.back()->at(i)->back()->at(0) = _patt->spn[iter]->at(i)->at(par_pos)->at(0);
-				if ((*it2)->attr[chil_ID_pos]->at((*tot_spn)[i])->at(0) > _patt->spn[iter]->at(i)->at(par_pos)->at(1))
-					(*pot_patt)[(*it2)->item - 1]->spn.back()->at(i)->back()->at(1) = (*it2)->attr[chil_ID_pos]->at((*tot_spn)[i])->at(0);
-				else
-					(*pot_patt)[(*it2)->item - 1]->spn.back()->at(i)->back()->at(1) = _patt->spn[iter]->at(i)->at(par_pos)->at(1);
-			}
-
-			for (int i = 0; i < (*tot_avr).size(); i++) {
-				if ((*pot_patt)[(*it2)->item - 1]->avr.back()->size() < (*tot_avr).size())
-					(*pot_patt)[(*it2)->item - 1]->avr.back()->push_back(new vector<int>);
-				(*pot_patt)[(*it2)->item - 1]->avr.back()->at(i)->push_back(_patt->avr[iter]->at(i)->at(par_pos) +  (*it2)->attr[chil_ID_pos]->at((*tot_avr)[i])->at(0));
-			}
-
-			for (int i = 0; i < (*lmedi).size(); i++){
-				if ((*pot_patt)[(*it2)->item - 1]->lmed.back()->size() < (*lmedi).size())
-					(*pot_patt)[(*it2)->item - 1]->lmed.back()->push_back(new vector<vector<int>*>);
-				(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->push_back(new vector<int>(3));
-				if ((*it2)->attr[chil_ID_pos]->at((*lmedi)[i])->at(0) < (*lmed)[i]){
-					(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(0) = _patt->lmed[iter]->at(i)->at(par_pos)->at(0) - 1;
-					(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(2) = _patt->lmed[iter]->at(i)->at(par_pos)->at(2);
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(1) > (*it2)->attr[chil_ID_pos]->at((*lmedi)[i])->at(0)) 				//max of mins
-						(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(1) = _patt->lmed[iter]->at(i)->at(par_pos)->at(1);
+			if constexpr (!Cons)
+				(*pot_patt)[(*it2)->item - 1]->str_pnt.push_back(*it2);
+			else {
+				int* rec = (*pot_patt)[(*it2)->item - 1]->add_pnt(*it2);		//information of the new start pointer, computed from the one of the parent
+				int* par = _patt->rec(ctx->iter, par_pos);
+
+				for (int i = 0; i < (*tot_spn).size(); i++) {
+					if ((*it2)->att(ctx->chil_ID_pos, (*tot_spn)[i])[0] < lay->spn(par, i)[0])
+						lay->spn(rec, i)[0] = (*it2)->att(ctx->chil_ID_pos, (*tot_spn)[i])[0];
 					else
-						(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(1) = (*it2)->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
-				}
-				else {
-					(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(0) = _patt->lmed[iter]->at(i)->at(par_pos)->at(0) + 1;
-					(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(1) = _patt->lmed[iter]->at(i)->at(par_pos)->at(1);
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(2) < (*it2)->attr[chil_ID_pos]->at((*lmedi)[i])->at(0)) 				//min of maxs
-						(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(2) = _patt->lmed[iter]->at(i)->at(par_pos)->at(2);
+						lay->spn(rec, i)[0] = lay->spn(par, i)[0];
+					if ((*it2)->att(ctx->chil_ID_pos, (*tot_spn)[i])[0] > lay->spn(par, i)[1])
+						lay->spn(rec, i)[1] = (*it2)->att(ctx->chil_ID_pos, (*tot_spn)[i])[0];
 					else
-						(*pot_patt)[(*it2)->item - 1]->lmed.back()->at(i)->back()->at(2) = (*it2)->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
+						lay->spn(rec, i)[1] = lay->spn(par, i)[1];
 				}
-			}
-			for (int i = 0; i < (*umedi).size(); i++){
-				if ((*pot_patt)[(*it2)->item - 1]->umed.back()->size() < (*umedi).size())
-					(*pot_patt)[(*it2)->item - 1]->umed.back()->push_back(new vector<vector<int>*>);
-				(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->push_back(new vector<int>(3));
-				if ((*it2)->attr[chil_ID_pos]->at((*umedi)[i])->at(0) <= (*umed)[i]){
-					(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(0) = _patt->umed[iter]->at(i)->at(par_pos)->at(0) + 1;
-					(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(2) = _patt->umed[iter]->at(i)->at(par_pos)->at(2);
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(1) > (*it2)->attr[chil_ID_pos]->at((*umedi)[i])->at(0))				//max of mins
-						(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(1) = _patt->umed[iter]->at(i)->at(par_pos)->at(1);
-					else
-						(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(1) = (*it2)->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+
+				for (int i = 0; i < (*tot_avr).size(); i++) {
+					lay->avr(rec, i)[0] = lay->avr(par, i)[0] + (*it2)->att(ctx->chil_ID_pos, (*tot_avr)[i])[0];
 				}
-				else {
-					(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(0) = _patt->umed[iter]->at(i)->at(par_pos)->at(0) - 1;
-					(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(1) = _patt->umed[iter]->at(i)->at(par_pos)->at(1);
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(2) < (*it2)->attr[chil_ID_pos]->at((*umedi)[i])->at(0))				//min of maxs
-						(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(2) = _patt->umed[iter]->at(i)->at(par_pos)->at(2);
-					else
-						(*pot_patt)[(*it2)->item - 1]->umed.back()->at(i)->back()->at(2) = (*it2)->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+
+				for (int i = 0; i < (*lmedi).size(); i++){
+					if ((*it2)->att(ctx->chil_ID_pos, (*lmedi)[i])[0] < (*lmed)[i]){
+						lay->lmed(rec, i)[0] = lay->lmed(par, i)[0] - 1;
+						lay->lmed(rec, i)[2] = lay->lmed(par, i)[2];
+						if (lay->lmed(par, i)[1] > (*it2)->att(ctx->chil_ID_pos, (*lmedi)[i])[0]) 				//max of mins
+							lay->lmed(rec, i)[1] = lay->lmed(par, i)[1];
+						else
+							lay->lmed(rec, i)[1] = (*it2)->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
+					}
+					else {
+						lay->lmed(rec, i)[0] = lay->lmed(par, i)[0] + 1;
+						lay->lmed(rec, i)[1] = lay->lmed(par, i)[1];
+						if (lay->lmed(par, i)[2] < (*it2)->att(ctx->chil_ID_pos, (*lmedi)[i])[0]) 				//min of maxs
+							lay->lmed(rec, i)[2] = lay->lmed(par, i)[2];
+						else
+							lay->lmed(rec, i)[2] = (*it2)->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
+					}
+				}
+				for (int i = 0; i < (*umedi).size(); i++){
+					if ((*it2)->att(ctx->chil_ID_pos, (*umedi)[i])[0] <= (*umed)[i]){
+						lay->umed(rec, i)[0] = lay->umed(par, i)[0] + 1;
+						lay->umed(rec, i)[2] = lay->umed(par, i)[2];
+						if (lay->umed(par, i)[1] > (*it2)->att(ctx->chil_ID_pos, (*umedi)[i])[0])				//max of mins
+							lay->umed(rec, i)[1] = lay->umed(par, i)[1];
+						else
+							lay->umed(rec, i)[1] = (*it2)->att(ctx->chil_ID_pos, (*umedi)[i])[0];
+					}
+					else {
+						lay->umed(rec, i)[0] = lay->umed(par, i)[0] - 1;
+						lay->umed(rec, i)[1] = lay->umed(par, i)[1];
+						if (lay->umed(par, i)[2] < (*it2)->att(ctx->chil_ID_pos, (*umedi)[i])[0])				//min of maxs
+							lay->umed(rec, i)[2] = lay->umed(par, i)[2];
+						else
+							lay->umed(rec, i)[2] = (*it2)->att(ctx->chil_ID_pos, (*umedi)[i])[0];
+					}
 				}
 			}
-
-
 		}
 		chil_pos--;
 	}
 }
 
 
-int Check_cons(int ID, int par_pos, Node* tnod, Pattern* _patt, vector<int>* umedi, vector<int>* lmedi, vector<int>* uspni, 
+int Check_cons(Mine_ctx* ctx, int ID, int par_pos, Node* tnod, Pattern* _patt, vector<int>* umedi, vector<int>* lmedi, vector<int>* uspni, 
 vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn,
 vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med) {		//constriant satisfaction
 
-	chil_ID_pos = find_ID(ID + 1, &tnod->seq_ID);   								//position of ID in child vector
+	ctx->chil_ID_pos = find_ID(ID + 1, &tnod->seq_ID);   								//position of ID in child vector
+	int* par = _patt->rec(ctx->iter, par_pos);										//information of the parent start pointer
+	const Attr_layout* lay = _patt->lay;
 	int satis = 1;
 
 	int att_pos = 0;												//position of attribute in constraint vector
 	for (vector<int>::iterator it = (*uspni).begin(); it != (*uspni).end(); it++){					//upper bound span, antimonotone, pattern cannot be extended to any feasible one for this node or any other node (child)
-		if (*it == 0 && tnod->attr[chil_ID_pos]->at(*it)->at(0) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0) > (*uspn)[att_pos])
+		if (*it == 0 && tnod->att(ctx->chil_ID_pos, *it)[0] - lay->spn(par, att_pos)[0] > (*uspn)[att_pos])
 			return -1;
 		else if(*it != 0){
 			int act_spn;
-			if (tnod->attr[chil_ID_pos]->at(*it)->at(0) < _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0))
-				act_spn = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1) - tnod->attr[chil_ID_pos]->at(*it)->at(0);
-			else if(tnod->attr[chil_ID_pos]->at(*it)->at(0) > _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1))
-				act_spn = tnod->attr[chil_ID_pos]->at(*it)->at(0) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0);
+			if (tnod->att(ctx->chil_ID_pos, *it)[0] < lay->spn(par, att_pos)[0])
+				act_spn = lay->spn(par, att_pos)[1] - tnod->att(ctx->chil_ID_pos, *it)[0];
+			else if(tnod->att(ctx->chil_ID_pos, *it)[0] > lay->spn(par, att_pos)[1])
+				act_spn = tnod->att(ctx->chil_ID_pos, *it)[0] - lay->spn(par, att_pos)[0];
 			else
-				act_spn = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0);
+				act_spn = lay->spn(par, att_pos)[1] - lay->spn(par, att_pos)[0];
 			if (act_spn > (*uspn)[att_pos])
 				return 0;
 		}
@@ -251,30 +464,30 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 
 	att_pos = 0;
 	for (vector<int>::iterator it = (*lspni).begin(); it != (*lspni).end(); it++){					//lower bound span, if condition holds, current node cannot be extended to feasible one but later nodes may
-		if (*it == 0 && tnod->attr[chil_ID_pos]->at(*it)->at(0) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0) < (*lspn)[att_pos]){
-			if (tnod->attr[chil_ID_pos]->at(*it)->at(2) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0) < (*lspn)[att_pos])
+		if (*it == 0 && tnod->att(ctx->chil_ID_pos, *it)[0] - lay->spn(par, att_pos)[0] < (*lspn)[att_pos]){
+			if (tnod->att(ctx->chil_ID_pos, *it)[2] - lay->spn(par, att_pos)[0] < (*lspn)[att_pos])
 				return 0;
 			else
 				satis = 2;
 		}
 		else if (*it != 0){ 
 			int act_spn;		
-			if (tnod->attr[chil_ID_pos]->at(*it)->at(0) < _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0))
-				act_spn = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1) - tnod->attr[chil_ID_pos]->at(*it)->at(0);
-			else if(tnod->attr[chil_ID_pos]->at(*it)->at(0) > _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1))
-				act_spn = tnod->attr[chil_ID_pos]->at(*it)->at(0) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0);
+			if (tnod->att(ctx->chil_ID_pos, *it)[0] < lay->spn(par, att_pos)[0])
+				act_spn = lay->spn(par, att_pos)[1] - tnod->att(ctx->chil_ID_pos, *it)[0];
+			else if(tnod->att(ctx->chil_ID_pos, *it)[0] > lay->spn(par, att_pos)[1])
+				act_spn = tnod->att(ctx->chil_ID_pos, *it)[0] - lay->spn(par, att_pos)[0];
 			else
-				act_spn = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1) - _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0);
+				act_spn = lay->spn(par, att_pos)[1] - lay->spn(par, att_pos)[0];
 			if (act_spn < (*lspn)[att_pos]){
 				int low, hig;
-				if (tnod->attr[chil_ID_pos]->at(*it)->at(2) > _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1))
-					hig = tnod->attr[chil_ID_pos]->at(*it)->at(2);
+				if (tnod->att(ctx->chil_ID_pos, *it)[2] > lay->spn(par, att_pos)[1])
+					hig = tnod->att(ctx->chil_ID_pos, *it)[2];
 				else
-					hig = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(1);
-				if (tnod->attr[chil_ID_pos]->at(*it)->at(1) < _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0))
-					low = tnod->attr[chil_ID_pos]->at(*it)->at(1);
+					hig = lay->spn(par, att_pos)[1];
+				if (tnod->att(ctx->chil_ID_pos, *it)[1] < lay->spn(par, att_pos)[0])
+					low = tnod->att(ctx->chil_ID_pos, *it)[1];
 				else
-					low = _patt->spn[iter]->at(att_pos)->at(par_pos)->at(0);
+					low = lay->spn(par, att_pos)[0];
 				if (hig - low < (*lspn)[att_pos])
 					return 0;
 				else
@@ -285,59 +498,59 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 	}
 
 	for (int att = 0; att < (*uavri).size(); att++){
-		double act_pavr = (double)(_patt->avr[iter]->at(att)->at(par_pos) + tnod->attr[chil_ID_pos]->at((*uavri)[att])->at(0)) / (_patt->patt_seq.size() + 1);
+		double act_pavr = (double)(lay->avr(par, att)[0] + tnod->att(ctx->chil_ID_pos, (*uavri)[att])[0]) / (_patt->patt_seq.size() + 1);
 		if (act_pavr <= (*uavr)[att])
 			continue;
 		else
 			satis = 2;
-		double lb_pavr = (double)(_patt->avr[iter]->at(att)->at(par_pos) + tnod->attr[chil_ID_pos]->at((*uavri)[att])->at((*num_minmax)[(*uavri)[att]] + 1)) / (_patt->patt_seq.size() + tnod->attr[chil_ID_pos]->at((*uavri)[att])->at((*num_minmax)[(*uavri)[att]] + (*num_avr)[(*uavri)[att]] + 1));
+		double lb_pavr = (double)(lay->avr(par, att)[0] + tnod->att(ctx->chil_ID_pos, (*uavri)[att])[(*num_minmax)[(*uavri)[att]] + 1]) / (_patt->patt_seq.size() + tnod->att(ctx->chil_ID_pos, (*uavri)[att])[(*num_minmax)[(*uavri)[att]] + (*num_avr)[(*uavri)[att]] + 1]);
 		if (lb_pavr > (*uavr)[att])
 			return 0;
 	}
 
 	for (int att = 0; att < (*lavri).size(); att++){
-		double act_pavr = (double)(_patt->avr[iter]->at(att)->at(par_pos) + tnod->attr[chil_ID_pos]->at((*lavri)[att])->at(0)) / (_patt->patt_seq.size() + 1);
+		double act_pavr = (double)(lay->avr(par, att)[0] + tnod->att(ctx->chil_ID_pos, (*lavri)[att])[0]) / (_patt->patt_seq.size() + 1);
 		if (act_pavr >= (*lavr)[att])
 			continue;
 		else
 			satis = 2;
-		double ub_pavr = (double)(_patt->avr[iter]->at(att)->at(par_pos) + tnod->attr[chil_ID_pos]->at((*lavri)[att])->at((*num_minmax)[(*lavri)[att]] + (*num_avr)[(*lavri)[att]])) / (_patt->patt_seq.size() + tnod->attr[chil_ID_pos]->at((*lavri)[att])->at((*num_minmax)[(*lavri)[att]] + 2 * (*num_avr)[(*lavri)[att]]));
+		double ub_pavr = (double)(lay->avr(par, att)[0] + tnod->att(ctx->chil_ID_pos, (*lavri)[att])[(*num_minmax)[(*lavri)[att]] + (*num_avr)[(*lavri)[att]]]) / (_patt->patt_seq.size() + tnod->att(ctx->chil_ID_pos, (*lavri)[att])[(*num_minmax)[(*lavri)[att]] + 2 * (*num_avr)[(*lavri)[att]]]);
 		if (ub_pavr < (*lavr)[att])
 			return 0;
 	}
 
 	for (int i = 0; i < (*lmedi).size(); i++){
-		if (tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0) < (*lmed)[i]){
-			if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) - 1 > 0)
+		if (tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0] < (*lmed)[i]){
+			if (lay->lmed(par, i)[0] - 1 > 0)
 				continue;
 			else{
-				if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) - 1 == 0){
+				if (lay->lmed(par, i)[0] - 1 == 0){
 					int max_min;
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0))
-						max_min = _patt->lmed[iter]->at(i)->at(par_pos)->at(1);
+					if (lay->lmed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0])
+						max_min = lay->lmed(par, i)[1];
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
-					if (0.5 * (_patt->lmed[iter]->at(i)->at(par_pos)->at(2) + max_min) >= (*lmed)[i])
+						max_min = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
+					if (0.5 * (lay->lmed(par, i)[2] + max_min) >= (*lmed)[i])
 						continue;
 				}
 				// algo only reaches here if constraint is infeasible when extended by tnod, thus cheking best case scenario in following lines
-				if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) - 1 + tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1) < 0)
+				if (lay->lmed(par, i)[0] - 1 + tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1] < 0)
 					return 0;
-				else if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) - 1 + tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1) == 0){
+				else if (lay->lmed(par, i)[0] - 1 + tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1] == 0){
 					int max_min, min_max, max_patt2;
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0))
-						max_patt2 = _patt->lmed[iter]->at(i)->at(par_pos)->at(1);
+					if (lay->lmed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0])
+						max_patt2 = lay->lmed(par, i)[1];
 					else
-						max_patt2 = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
+						max_patt2 = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
 
-					if (max_patt2 > tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2))
+					if (max_patt2 > tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2])
 						max_min = max_patt2;
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2);
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3))
-						min_max = _patt->lmed[iter]->at(i)->at(par_pos)->at(2);
+						max_min = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2];
+					if (lay->lmed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3])
+						min_max = lay->lmed(par, i)[2];
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3);
+						min_max = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3];
 
 					if (0.5 * (min_max + max_min) < (*lmed)[i])
 						return 0;
@@ -346,35 +559,35 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 			}
 		}
 		else{
-			if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) + 1 > 0)
+			if (lay->lmed(par, i)[0] + 1 > 0)
 				continue;
 			else{  
-				if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) + 1 == 0){
+				if (lay->lmed(par, i)[0] + 1 == 0){
 					int min_max;
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0))
-						min_max = _patt->lmed[iter]->at(i)->at(par_pos)->at(2);
+					if (lay->lmed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0])
+						min_max = lay->lmed(par, i)[2];
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
-					if (0.5 * (min_max + _patt->lmed[iter]->at(i)->at(par_pos)->at(1)) >= (*lmed)[i])
+						min_max = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
+					if (0.5 * (min_max + lay->lmed(par, i)[1]) >= (*lmed)[i])
 						continue;
 				}
 				// algo only reaches here if constraint is infeasible when extended by tnod, thus cheking best case scenario in following lines
-				if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) + 1 + tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1) < 0)
+				if (lay->lmed(par, i)[0] + 1 + tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1] < 0)
 					return 0;
-				else if (_patt->lmed[iter]->at(i)->at(par_pos)->at(0) + 1 + tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1) == 0){
+				else if (lay->lmed(par, i)[0] + 1 + tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 1] == 0){
 					int max_min, min_max, min_patt3;
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0))
-						min_patt3 = _patt->lmed[iter]->at(i)->at(par_pos)->at(2);
+					if (lay->lmed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0])
+						min_patt3 = lay->lmed(par, i)[2];
 					else
-						min_patt3 = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at(0);
-					if (_patt->lmed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2))
-						max_min = _patt->lmed[iter]->at(i)->at(par_pos)->at(1);
+						min_patt3 = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[0];
+					if (lay->lmed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2])
+						max_min = lay->lmed(par, i)[1];
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2);
-					if (min_patt3 < tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3))
+						max_min = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 2];
+					if (min_patt3 < tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3])
 						min_max = min_patt3;
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*lmedi)[i])->at((*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3);
+						min_max = tnod->att(ctx->chil_ID_pos, (*lmedi)[i])[(*num_minmax)[(*lmedi)[i]] + (*num_avr)[(*lmedi)[i]] * 2 + 3];
 
 					if (0.5 * (min_max + max_min) < (*lmed)[i])
 						return 0;
@@ -385,38 +598,38 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 	}
 
 	for (int i = 0; i < (*umedi).size(); i++){
-		if (tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0) > (*umed)[i]){
-			if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) - 1 > 0)
+		if (tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0] > (*umed)[i]){
+			if (lay->umed(par, i)[0] - 1 > 0)
 				continue;
 			else{
-				if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) - 1 == 0){
+				if (lay->umed(par, i)[0] - 1 == 0){
 					int min_max;
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0))
-						min_max = _patt->umed[iter]->at(i)->at(par_pos)->at(2);
+					if (lay->umed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0])
+						min_max = lay->umed(par, i)[2];
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+						min_max = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0];
 
-					if (0.5 * (min_max + _patt->umed[iter]->at(i)->at(par_pos)->at(1)) <= (*umed)[i])
+					if (0.5 * (min_max + lay->umed(par, i)[1]) <= (*umed)[i])
 						continue;
 				}
 				// algo only reaches here if constraint is infeasible when extended by tnod, thus cheking best case scenario in following lines
-				if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) -1 + tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1) < 0)
+				if (lay->umed(par, i)[0] -1 + tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1] < 0)
 					return 0;
-				else if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) -1 + tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1) == 0){
+				else if (lay->umed(par, i)[0] -1 + tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1] == 0){
 					int max_min, min_max, min_patt3;
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0))
-						min_patt3 = _patt->umed[iter]->at(i)->at(par_pos)->at(2);
+					if (lay->umed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0])
+						min_patt3 = lay->umed(par, i)[2];
 					else
-						min_patt3 = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+						min_patt3 = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0];
 
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2))
-						max_min = _patt->umed[iter]->at(i)->at(par_pos)->at(1);
+					if (lay->umed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2])
+						max_min = lay->umed(par, i)[1];
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2);
-					if (min_patt3 < tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3))
+						max_min = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2];
+					if (min_patt3 < tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3])
 						min_max = min_patt3;
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3);
+						min_max = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3];
 
 					if (0.5 * (min_max + max_min) > (*umed)[i])
 						return 0;
@@ -425,37 +638,37 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 			}
 		}
 		else{
-			if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) + 1 > 0)
+			if (lay->umed(par, i)[0] + 1 > 0)
 				continue;
 			else{   
-				if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) + 1 == 0){
+				if (lay->umed(par, i)[0] + 1 == 0){
 					int max_min;
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0))
-						max_min = _patt->umed[iter]->at(i)->at(par_pos)->at(1);
+					if (lay->umed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0])
+						max_min = lay->umed(par, i)[1];
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+						max_min = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0];
 
-					if (0.5 * (_patt->umed[iter]->at(i)->at(par_pos)->at(2) + max_min) <= (*umed)[i])
+					if (0.5 * (lay->umed(par, i)[2] + max_min) <= (*umed)[i])
 						continue;
 				}
 				// algo only reaches here if constraint is infeasible when extended by tnod, thus cheking best case scenario in following lines
-				if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) + 1 + tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1) < 0)
+				if (lay->umed(par, i)[0] + 1 + tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1] < 0)
 					return 0;
-				else if (_patt->umed[iter]->at(i)->at(par_pos)->at(0) + 1 + tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1) == 0){
+				else if (lay->umed(par, i)[0] + 1 + tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 1] == 0){
 					int max_min, min_max, max_patt2;
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(1) > tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0))
-						max_patt2 = _patt->umed[iter]->at(i)->at(par_pos)->at(1);
+					if (lay->umed(par, i)[1] > tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0])
+						max_patt2 = lay->umed(par, i)[1];
 					else
-						max_patt2 = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at(0);
+						max_patt2 = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[0];
 
-					if (max_patt2 > tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2))
+					if (max_patt2 > tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2])
 						max_min = max_patt2;
 					else
-						max_min = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2);
-					if (_patt->umed[iter]->at(i)->at(par_pos)->at(2) < tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3))
-						min_max = _patt->umed[iter]->at(i)->at(par_pos)->at(2);
+						max_min = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 2];
+					if (lay->umed(par, i)[2] < tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3])
+						min_max = lay->umed(par, i)[2];
 					else
-						min_max = tnod->attr[chil_ID_pos]->at((*umedi)[i])->at((*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3);
+						min_max = tnod->att(ctx->chil_ID_pos, (*umedi)[i])[(*num_minmax)[(*umedi)[i]] + (*num_avr)[(*umedi)[i]] * 2 + ((*num_med)[(*umedi)[i]] - 1) * 3 + 3];
 
 					if (0.5 * (min_max + max_min) > (*umed)[i])
 						return 0;
@@ -472,7 +685,7 @@ vector<int>* lmed, vector<int>* umed, vector<int>* num_minmax, vector<int>* num_
 }
 
 
-int find_ID(int ID, vector<int>* vec) {
+int find_ID(int ID, pmr::vector<int>* vec) {
 	int l = 0;
 	int u = vec->size()-1;
 
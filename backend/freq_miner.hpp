@@ -3,16 +3,86 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
 #include "pattern.hpp"
 #include "node_mdd.hpp"
 
+// Receives every maximal pattern as soon as it is found (the items, then the frequency). Returning false stops the mining.
+typedef std::function<bool(const vector<int>&)> Patt_sink;
+
+// Top-k mining: instead of all patterns keep the k with the largest frequency (equal frequency: the one the serial
+// miner finds first). Once there are k, theta is raised to the smallest frequency kept, so subtrees that cannot
+// reach it are not mined. Shared by all threads of a parallel mining run.
+struct Top_k {
+	struct Entry {
+		vector<int> patt;					//items, then the frequency
+		int order;							//subtree it was found in and position in that subtree, the serial order
+		int index;
+	};
+	int k;
+	std::atomic<int> theta;					//frequency a pattern needs to be kept
+	std::mutex lock;
+	vector<Entry> heap;						//the kept patterns, worst in front
+
+	Top_k(int k, int theta) : k(k), theta(theta) {}
+	void Offer(const vector<int>& patt, int order, int index);
+	// hands the kept patterns to sink, most frequent first, returns how many it took
+	int Flush(Patt_sink* sink);
+};
+
+// State of a single mining run (used to be global variables). Every call to Seq2pat::mine() has its
+// own, so several mines can run at the same time on different data.
+struct Mine_ctx {
+	vector<bool> indic_vec;				//event types that can still extend the current pattern
+	vector<int> item_count;				//per event type, sequences in which it extends the current pattern
+	vector<Pattern*> pot_patt;			//per event type, the extended pattern
+	vector<int> touched;				//event types changed in the three vectors above, they are reset after each extension
+	vector<vector<int>> result;			//mined patterns, last element of each is its frequency (if there is no sink)
+	Patt_sink* sink = NULL;				//if set mined patterns go here instead of into result
+	bool stop = false;					//the sink asked us to stop
+	int num_max_patt = 0;				//number of mined patterns
+	int iter = 0;						//position of the sequence under consideration in the current pattern
+	int chil_ID_pos = 0;				//position of that sequence in the child node
+	pmr::unsynchronized_pool_resource pool;	//patterns created by this run, released with the context
+	pmr::memory_resource* mr = &pool;
+	const std::atomic<int>* cutoff = NULL;	//parallel mining: stop if the subtree we mine (order) comes after cutoff
+	int order = 0;
+	const std::atomic<bool>* cancel = NULL;	//set by the caller (e.g. on Ctrl-C) to stop mining
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();	//stop mining after this
+	bool interrupted = false;				//stopped because of cancel or deadline, the patterns found so far are kept
+	Top_k* top = NULL;						//if set mined patterns are offered here instead of sink or result
+};
+
+// True if the caller cancelled the mining or the time for it is up
+inline bool Out_of_time(const Mine_ctx* ctx) {
+	if (ctx->cancel != NULL && ctx->cancel->load(std::memory_order_relaxed))
+		return true;
+	return std::chrono::steady_clock::now() > ctx->deadline;
+}
+
 // Changed signature
-// Returns the output
-vector<vector<int>> Freq_miner(vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+// Patterns go to ctx->sink or ctx->result, returns their number
+int Freq_miner(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
 	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, 
-	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr);
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L, int max_number_of_pattern);
 
-void Out_final_patt(vector<int>* seq, int freq, vector<Pattern*>* dfs_q);
+// Same as Freq_miner but the subtrees of the initial patterns in dfs_q are mined in parallel. The sink gets the
+// same patterns in the same order as from Freq_miner, one subtree at a time and never from two threads at once.
+// Only sink, cancel and deadline of ctx are used, interrupted is set if one of the subtrees was interrupted.
+int Freq_miner_parallel(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, 
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L, int max_number_of_pattern);
+
+// Serial top-k mining (ctx->top is set): same patterns as Freq_miner, the subtrees of the initial patterns in
+// dfs_q are mined most frequent first so theta goes up early. Returns the number of patterns kept.
+int Freq_miner_top(Mine_ctx* ctx, vector<Pattern*>* dfs_q, vector<int>* uspni, vector<int>* lspni, vector<int>* uavri, vector<int>* lavri, vector<int>* umedi, 
+	vector<int>* lmedi, vector<int>* lavr, vector<int>* uavr, vector<int>* lspn, vector<int>* uspn, vector<int>* lmed, vector<int>* umed, 
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int theta, int L);
 
-extern int num_patt;
-extern int num_max_patt;
+// Position of ID in the sorted vec (seq_ID of a node or pattern), -1 if it is not in there
+int find_ID(int ID, pmr::vector<int>* vec);
+
+void Out_final_patt(vector<int>* seq, int freq, vector<Pattern*>* dfs_q);
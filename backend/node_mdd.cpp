@@ -7,47 +7,49 @@
 #include "node_mdd.hpp"
 #include "build_mdd.hpp"
 
-void Update_minmax(vector<int>& att_fnod, vector<int>& att_tnod);
-void Update_sum(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr);
-void Update_med(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
+void Update_minmax(int* att_fnod, int* att_tnod);
+void Update_sum(int* att_fnod, int* att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr);
+void Update_med(int* att_fnod, int* att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
 	vector<int>* max_attrs, vector<int>* min_attrs);
 
 
 void Node::assign_ID(int ID, int lvl, Node* tnod, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
 	vector<int>* lavr, vector<int>* uavr, vector<int>* lmed, vector<int>* umed, 
-	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int num_att, 
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, int num_att, 
 	vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs) {
 
 	if (seq_ID.empty() || seq_ID.back() != ID) {
 
 		seq_ID.push_back(ID);
-		children.push_back(new vector<Node*>);
+		children.push_back(Arena_new<Node_list>(mr));
 		item = (*items)[ID - 1].at(lvl - 1);
-		attr.emplace_back(new vector<vector<int>*>(num_att, NULL));
-		if (!(*tot_spn).empty() || !(*tot_avr).empty() || !(*umedi).empty() || !(*lmedi).empty()){
+		if (lay->att_stride > 0){
+			attr.resize(attr.size() + lay->att_stride);
 			for (int att = 0; att < num_att; att++){
-				attr.back()->at(att) = new vector<int>(1 + (*num_minmax)[att] + (*num_avr)[att] * 2 + (*num_med)[att] * 3, (*attrs)[att].at(ID - 1).at(lvl - 1));
+				int* a = last_att(att);
+				for (int ii = 0; ii < 1 + (*num_minmax)[att] + (*num_avr)[att] * 2 + (*num_med)[att] * 3; ii++)
+					a[ii] = (*attrs)[att].at(ID - 1).at(lvl - 1);
 				for (int ii = 0; ii < (*num_avr)[att]; ii++)
-					attr.back()->at(att)->at(1 + (*num_minmax)[att] + (*num_avr)[att] + ii) = 1;
+					a[1 + (*num_minmax)[att] + (*num_avr)[att] + ii] = 1;
 			}
 			for (int att = 0; att < (*lmedi).size(); att++){
 				if ((*attrs)[(*lmedi)[att]].at(ID - 1).at(lvl - 1) < (*lmed)[att]){
-					attr.back()->at((*lmedi)[att])->at((*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 1) = 0;
-					attr.back()->at((*lmedi)[att])->at((*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 3) = (*max_attrs)[(*lmedi)[att]] + 1;
+					last_att((*lmedi)[att])[(*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 1] = 0;
+					last_att((*lmedi)[att])[(*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 3] = (*max_attrs)[(*lmedi)[att]] + 1;
 				}
 				else{
-					attr.back()->at((*lmedi)[att])->at((*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 1) = 0;
-					attr.back()->at((*lmedi)[att])->at((*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 2) = (*min_attrs)[(*lmedi)[att]] - 1;
+					last_att((*lmedi)[att])[(*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 1] = 0;
+					last_att((*lmedi)[att])[(*num_minmax)[(*lmedi)[att]] + (*num_avr)[(*lmedi)[att]] * 2 + 2] = (*min_attrs)[(*lmedi)[att]] - 1;
 				}
 			}
 			for (int att = 0; att < (*umedi).size(); att++){
 				if ((*attrs)[(*umedi)[att]].at(ID - 1).at(lvl - 1) > (*umed)[att]){
-					attr.back()->at((*umedi)[att])->at((*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 1) = 0;
-					attr.back()->at((*umedi)[att])->at((*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 2) = (*min_attrs)[(*umedi)[att]] - 1;
+					last_att((*umedi)[att])[(*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 1] = 0;
+					last_att((*umedi)[att])[(*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 2] = (*min_attrs)[(*umedi)[att]] - 1;
 				}
 				else{
-					attr.back()->at((*umedi)[att])->at((*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 1) = 0;
-					attr.back()->at((*umedi)[att])->at((*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 3) = (*max_attrs)[(*umedi)[att]] + 1;
+					last_att((*umedi)[att])[(*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 1] = 0;
+					last_att((*umedi)[att])[(*num_minmax)[(*umedi)[att]] + (*num_avr)[(*umedi)[att]] * 2 + ((*num_med)[(*umedi)[att]] - 1) * 3 + 3] = (*max_attrs)[(*umedi)[att]] + 1;
 				}
 			}
 
@@ -58,30 +60,30 @@ void Node::assign_ID(int ID, int lvl, Node* tnod, vector<int>* lspni, vector<int
 		children.back()->push_back(tnod);
 		
 		for (vector<int>::iterator it = (*lspni).begin(); it != (*lspni).end(); it++){
-			Update_minmax(*(attr.back()->at(*it)), *(tnod->attr.back()->at(*it)));
+			Update_minmax(last_att(*it), tnod->last_att(*it));
 		}
 
 		int att = 0;
 		for (vector<int>::iterator it = (*uavri).begin(); it != (*uavri).end(); it++){
-			Update_sum(*(attr.back()->at(*it)), *(tnod->attr.back()->at(*it)), *it, (*uavr)[att], 1, num_minmax, num_avr);
+			Update_sum(last_att(*it), tnod->last_att(*it), *it, (*uavr)[att], 1, num_minmax, num_avr);
 			att++;
 		}
 
 		att = 0;
 		for (vector<int>::iterator it = (*lavri).begin(); it != (*lavri).end(); it++){
-			Update_sum(*(attr.back()->at(*it)), *(tnod->attr.back()->at(*it)), *it, (*lavr)[att], 0, num_minmax, num_avr);
+			Update_sum(last_att(*it), tnod->last_att(*it), *it, (*lavr)[att], 0, num_minmax, num_avr);
 			att++;
 		}
 
 		att = 0;
 		for (vector<int>::iterator it = (*umedi).begin(); it != (*umedi).end(); it++){
-			Update_med(*(attr.back()->at(*it)), *(tnod->attr.back()->at(*it)), *it, (*umed)[att], 1, num_minmax, num_avr, num_med, max_attrs, min_attrs);
+			Update_med(last_att(*it), tnod->last_att(*it), *it, (*umed)[att], 1, num_minmax, num_avr, num_med, max_attrs, min_attrs);
 			att++;
 		}
 
 		att = 0;
 		for (vector<int>::iterator it = (*lmedi).begin(); it != (*lmedi).end(); it++){
-			Update_med(*(attr.back()->at(*it)), *(tnod->attr.back()->at(*it)), *it, (*lmed)[att], 0, num_minmax, num_avr, num_med, max_attrs, min_attrs);
+			Update_med(last_att(*it), tnod->last_att(*it), *it, (*lmed)[att], 0, num_minmax, num_avr, num_med, max_attrs, min_attrs);
 			att++;
 		}
 
@@ -89,7 +91,7 @@ void Node::assign_ID(int ID, int lvl, Node* tnod, vector<int>* lspni, vector<int
 
 }
 
-void Update_minmax(vector<int>& att_fnod, vector<int>& att_tnod){
+void Update_minmax(int* att_fnod, int* att_tnod){
 	
 	if (att_tnod[1] < att_fnod[1])
 		att_fnod[1] = att_tnod[1];
@@ -98,7 +100,7 @@ void Update_minmax(vector<int>& att_fnod, vector<int>& att_tnod){
 
 }
 
-void Update_sum(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr) {
+void Update_sum(int* att_fnod, int* att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr) {
 
 	if (ub && val * (1 + att_tnod[(*num_minmax)[att] + (*num_avr)[att] + 1]) - (att_fnod[0] + att_tnod[(*num_minmax)[att] + 1]) > val * att_fnod[(*num_minmax)[att] + (*num_avr)[att] + 1] - att_fnod[(*num_minmax)[att] + 1]){
 		att_fnod[(*num_minmax)[att] + 1] = att_fnod[0] + att_tnod[(*num_minmax)[att] + 1];
@@ -112,7 +114,7 @@ void Update_sum(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val,
 }
 
 
-void Update_med(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
+void Update_med(int* att_fnod, int* att_tnod, int att, int val, bool ub, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
 	vector<int>* max_attrs, vector<int>* min_attrs){
 
 	if (ub){
@@ -218,3 +220,24 @@ void Update_med(vector<int>& att_fnod, vector<int>& att_tnod, int att, int val,
 		}
 	}
 }
+
+
+Attr_layout Make_layout(int num_att, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
+	vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* lmedi, vector<int>* umedi) {		//column layout of Node::attr and Pattern::info for this set of constraints
+
+	Attr_layout lay;
+	lay.att_stride = 0;
+	if (!(*tot_spn).empty() || !(*tot_avr).empty() || !(*umedi).empty() || !(*lmedi).empty()){		//nodes only keep information for these constraints
+		for (int att = 0; att < num_att; att++){
+			lay.att_off.push_back(lay.att_stride);
+			lay.att_stride += 1 + (*num_minmax)[att] + (*num_avr)[att] * 2 + (*num_med)[att] * 3;
+		}
+	}
+
+	lay.spn_off = 0;
+	lay.avr_off = lay.spn_off + 2 * (*tot_spn).size();
+	lay.lmed_off = lay.avr_off + (*tot_avr).size();
+	lay.umed_off = lay.lmed_off + 3 * (*lmedi).size();
+	lay.info_stride = lay.umed_off + 3 * (*umedi).size();
+	return lay;
+}
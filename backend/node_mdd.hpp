@@ -4,44 +4,62 @@
 #pragma once
 
 #include<vector>
+#include <unordered_map>
+#include <cstdint>
+#include "arena.hpp"
 
 using namespace std;
 
+class Node;
+typedef pmr::vector<Node*> Node_list;
+typedef unordered_map<int64_t, Node*> Node_table;	//MDD nodes that exist, key is Node_key(level, item)
+
+inline int64_t Node_key(int lvl, int item, int L) { return (int64_t)(lvl - 1) * L + item; }
+
+// Column layout of the flat constraint information in Node::attr and Pattern::info, the same for all nodes and
+// patterns of a mining run (see Make_layout)
+struct Attr_layout {
+	vector<int> att_off;						//Node::attr, first column of each attribute inside a row
+	int att_stride;								//Node::attr, columns per row, 0 if there are no span, average or median constraints
+	int spn_off, avr_off, lmed_off, umed_off;	//Pattern::info, first column of each constraint type inside a record
+	int info_stride;							//Pattern::info, columns per record
+
+	// columns of constraint i inside the record rec of a pattern
+	int* spn(int* rec, int i) const { return rec + spn_off + 2 * i; }		//0:min, 1:max
+	int* avr(int* rec, int i) const { return rec + avr_off + i; }			//0:sum
+	int* lmed(int* rec, int i) const { return rec + lmed_off + 3 * i; }
+	int* umed(int* rec, int i) const { return rec + umed_off + 3 * i; }
+};
+
+Attr_layout Make_layout(int num_att, vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med,
+	vector<int>* tot_spn, vector<int>* tot_avr, vector<int>* lmedi, vector<int>* umedi);
+
 class Node {
 
 public:
 
-	int ID;									//Node number in graph
+	int64_t ID;								//Node number in graph
 	int parent;								//Used to determine whether node has parent w.r.t to a Seq ID
 	int item;
+	pmr::memory_resource* mr;				//arena of the MDD, all lists below are allocated there
+	const Attr_layout* lay;
+
+	pmr::vector<int> seq_ID;				//Vector which keeps the sequences associated to node
+	pmr::vector<int> attr;					//Critical information, one row of lay->att_stride columns per sequence, per attribute, columns: 0:actual, min:1, max:size_maxmin, min_sum:size_maxmin + 1, max_sum:size_maxmin + size_sum, num(avr):last
+	pmr::vector<Node_list*> children;
 
-	vector<int> seq_ID;						//Vector which keeps the sequences associated to node
-	vector<vector<vector<int>*>*> attr;		//Vector of critical information, one row per sequence, per attribute, columns: 0:actual, min:1, max:size_maxmin, min_sum:size_maxmin + 1, max_sum:size_maxmin + size_sum, num(avr):last
-	vector<vector<Node*>*> children;
+	int* att(int pos, int a) { return attr.data() + (size_t)pos * lay->att_stride + lay->att_off[a]; }		//information of attribute a in row pos
+	int* last_att(int a) { return att(seq_ID.size() - 1, a); }
 
 	void assign_ID(int ID, int lvl, Node* tnod, vector<int>* lspni, vector<int>* lmedi, vector<int>* umedi, vector<int>* lavri, vector<int>* uavri,
 	vector<int>* lavr, vector<int>* uavr, vector<int>* lmed, vector<int>* umed, 
-	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, vector<int>* tot_spn, vector<int>* tot_avr, int num_att, 
+	vector<int>* num_minmax, vector<int>* num_avr, vector<int>* num_med, int num_att, 
 	vector<int>* max_attrs, vector<int>* min_attrs, vector<vector<int> >* items, vector<vector<vector<int> > >* attrs);	 //Creates or updates the node information
 
-	Node() { ID = 0; parent = 0; item = 0; }			//Node constructor
-
-	~Node() {
-		for (int i = 0; i < children.size(); i++){
-			delete children[i];
-		}
-//		Clear the vector children and deallocate memory by swapping with an empty vector
-		std::vector<vector<Node*>*>().swap(children);
-
-		for (int i=0; i < attr.size(); i++){
-		    for (int j = 0; j < attr[i]->size(); j++)
-					delete attr[i]->at(j);
-		    delete attr[i];
-		}
-		std::vector<vector<vector<int>*>*>().swap(attr);
+	typedef pmr::polymorphic_allocator<> allocator_type;	//Arena_new<Node>(mr, lay) passes the arena to the constructor
+	Node(const Attr_layout* lay, const allocator_type& alloc) : mr(alloc.resource()), lay(lay), seq_ID(mr), attr(mr), children(mr) { ID = 0; parent = 0; item = 0; }			//Node constructor
 
-		std::vector<int>().swap(seq_ID);
-	}
+	// No destructor that frees the lists, they are released together with the arena at the end of mining.
 
 };
 
@@ -13,87 +13,74 @@ public:
 	int ID;
 	int freq;									    // #Seqs containing pattern
 	int act_freq;
+	pmr::memory_resource* mr;					    // where this pattern and its lists are allocated
+	const Attr_layout* lay;
 
-	vector<int> patt_seq;						    // Item sequence defining the pattern
+	pmr::vector<int> patt_seq;					    // Item sequence defining the pattern
 	bool cond;
-	vector<int> seq_ID;
+	pmr::vector<int> seq_ID;
 
-	vector<vector<Node*>*> str_pnt;				    // vector of pointers indicating the end position of a pattern inside the MDD, w.r.t. each seq
-	vector<vector<vector<vector<int>*>*>*> spn;			
-	vector<vector<vector<int>*>*> avr;			    // one row per sequence, per attribute, one column per start pointer
-	vector<vector<vector<vector<int>*>*>*> lmed;    // one row per sequence, per attribute, per start pointer, one column per information
-	vector<vector<vector<vector<int>*>*>*> umed;
+	Node_list str_pnt;							    // end positions of the pattern inside the MDD, the ones of seq_ID[i] start at seq_begin[i]
+	pmr::vector<int> seq_begin;
+	pmr::vector<int> info;						    // one record of lay->info_stride columns per start pointer, spn, avr, lmed and umed of every constraint
 
-	void Update(int seq, vector<int>* umedi, vector<int>* lmedi, vector<int>* tot_spn, vector<int>* tot_avr) {
+	void Update(int seq) {
 		seq_ID.push_back(seq);
-		str_pnt.push_back(new vector<Node*>);
-		if (!(*tot_spn).empty())
-			spn.push_back(new vector<vector<vector<int>*>*>);
-		if (!(*tot_avr).empty())
-			avr.push_back(new vector<vector<int>*>);
-		if (!(*lmedi).empty())
-			lmed.push_back(new vector<vector<vector<int>*>*>);
-		if (!(*umedi).empty())
-			umed.push_back(new vector<vector<vector<int>*>*>);
+		seq_begin.push_back(str_pnt.size());
 
 		cond = 1;
 		freq++;
 	}
 
-	Pattern() {
-		ID = 0;
-		freq = 0;
-		act_freq = 0;
+	int num_pnt(int pos) {							// number of start pointers of seq_ID[pos]
+		return (pos + 1 < seq_begin.size() ? seq_begin[pos + 1] : str_pnt.size()) - seq_begin[pos];
+	}
+	int* rec(int pos, int pnt) {					// record of start pointer pnt of seq_ID[pos]
+		return info.data() + (size_t)(seq_begin[pos] + pnt) * lay->info_stride;
+	}
+	int* add_pnt(Node* nod) {						// adds a start pointer to the last sequence, returns its (zeroed) record
+		str_pnt.push_back(nod);
+		info.resize(info.size() + lay->info_stride, 0);
+		return info.data() + info.size() - lay->info_stride;
 	}
 
-	~Pattern() {
-		for (int i = 0; i < str_pnt.size(); i++){
-			delete str_pnt[i];
-		}
-//		Clear the vector and deallocate memory
-		vector<vector<Node*>*>().swap(str_pnt);
-
-		for (int i = 0; i < spn.size(); i++){
-			for (int j = 0; j < spn[i]->size(); j++){
-				for (int k = 0; k < spn[i]->at(j)->size(); k++)
-					delete spn[i]->at(j)->at(k);
-				delete spn[i]->at(j);
-			}
-			delete spn[i];
-		}
-		vector<vector<vector<vector<int>*>*>*>().swap(spn);
-
-		for (int i = 0; i < avr.size(); i++){
-			for (int j = 0; j < avr[i]->size(); j++)
-					delete avr[i]->at(j);
-			delete avr[i];
-		}
-		vector<vector<vector<int>*>*>().swap(avr);
-
-		for (int i = 0; i < lmed.size(); i++){
-			for (int j = 0; j < lmed[i]->size(); j++){
-				for (int k = 0; k < lmed[i]->at(j)->size(); k++)
-					delete lmed[i]->at(j)->at(k);
-				delete lmed[i]->at(j);
-			}
-			delete lmed[i];
-		}
-		vector<vector<vector<vector<int>*>*>*>().swap(lmed);
-
-		for (int i = 0; i < umed.size(); i++){
-			for (int j = 0; j < umed[i]->size(); j++){
-				for (int k = 0; k < umed[i]->at(j)->size(); k++)
-					delete umed[i]->at(j)->at(k);
-				delete umed[i]->at(j);
-			}
-			delete umed[i];
-		}
-		vector<vector<vector<vector<int>*>*>*>().swap(umed);
-
-		vector<int>().swap(patt_seq);
-		vector<int>().swap(seq_ID);
+	void Remove(int pos) {							// takes seq_ID[pos] and its start pointers out of the pattern
+		int first = seq_begin[pos];
+		int num = num_pnt(pos);
+		str_pnt.erase(str_pnt.begin() + first, str_pnt.begin() + first + num);
+		info.erase(info.begin() + (size_t)first * lay->info_stride, info.begin() + (size_t)(first + num) * lay->info_stride);
+		seq_ID.erase(seq_ID.begin() + pos);
+		seq_begin.erase(seq_begin.begin() + pos);
+		for (int i = pos; i < seq_begin.size(); i++)
+			seq_begin[i] -= num;
+		freq--;
+	}
 
+	typedef pmr::polymorphic_allocator<> allocator_type;	//Arena_new<Pattern>(mr, lay) passes the arena to the constructor
+	Pattern(const Attr_layout* lay, const allocator_type& alloc) : mr(alloc.resource()), lay(lay), patt_seq(mr), seq_ID(mr), str_pnt(mr), seq_begin(mr), info(mr) {
+		ID = 0;
+		freq = 0;
+		act_freq = 0;
 	}
 
 };
 
+// Copy of a pattern in mr, mining frees the patterns it is given
+inline Pattern* Copy_patt(Pattern* patt, pmr::memory_resource* mr) {
+	Pattern* copy = Arena_new<Pattern>(mr, patt->lay);
+	copy->ID = patt->ID;
+	copy->freq = patt->freq;
+	copy->act_freq = patt->act_freq;
+	copy->cond = patt->cond;
+	copy->patt_seq.assign(patt->patt_seq.begin(), patt->patt_seq.end());
+	copy->seq_ID.assign(patt->seq_ID.begin(), patt->seq_ID.end());
+	copy->str_pnt.assign(patt->str_pnt.begin(), patt->str_pnt.end());
+	copy->seq_begin.assign(patt->seq_begin.begin(), patt->seq_begin.end());
+	copy->info.assign(patt->info.begin(), patt->info.end());
+	return copy;
+}
+
+// Destroys a pattern and gives its memory back to the resource it came from
+inline void Free_patt(Pattern* patt) {
+	Arena_delete(patt->mr, patt);
+}
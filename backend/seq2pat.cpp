@@ -23,43 +23,88 @@ namespace patterns {
     Seq2pat::Seq2pat ()
     {
         this->num_att = 0, this->theta = 0;
+        this->N = 0, this->M = 0, this->L = 0;
         this->max_number_of_pattern = -1;
+        this->top_k = 0;
+        this->parallel = false;
+        this->cancel = NULL;
+        this->max_mine_millis = 0;
+        this->interrupted = false;
     }
 
     Seq2pat::~Seq2pat () {}
 
     std::vector< std::vector<int> > Seq2pat::mine()
+    {
+        std::vector< std::vector<int> > results;
+        mine([&results](const std::vector<int>& pattern) {
+            results.push_back(pattern);
+            return true;
+        });
+        return results;
+    }
+
+    int Seq2pat::mine(pattern_sink_t sink)
     {
         // This is to create a single hold of data structures as the global objects to be passed into API calls.
-        // MDD database is essentially a vector of nodes
-        std::vector<Node*>* datab_MDD = new vector<Node*>(M * L, NULL);
+        // MDD database is a table of the nodes that exist (at most one per input event, not M * L),
+        // the nodes (and the initial patterns) live in mdd_arena
+        std::pmr::monotonic_buffer_resource mdd_arena;
+        size_t num_events = 0;
+        for (auto& seq : this->items)
+            num_events += seq.size();
+        Node_table* datab_MDD = new Node_table();
+        // where nodes and patterns keep the information for the span, average and median constraints
+        Attr_layout layout = Make_layout(this->num_att, &(this->num_minmax), &(this->num_avr), &(this->num_med),
+                                         &(this->tot_spn), &(this->tot_avr), &(this->lmedi), &(this->umedi));
         // mdd_q is DFS queue of patterns to extend in mining algorithm
         std::vector<Pattern*>* mdd_q = new vector<Pattern*>(L, NULL);
 
-        // results is to save mined patterns that satisfy constraints
-        std::vector< std::vector<int> > results;
+        // number of mined patterns that satisfy constraints, the patterns go to sink
+        int num_patterns = 0;
+        // state of this mining run, nothing is shared with other Seq2pat objects
+        Mine_ctx ctx;
+        ctx.sink = &sink;
+        ctx.cancel = this->cancel;
+        if (this->max_mine_millis > 0)
+            ctx.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(this->max_mine_millis);
+        // top-k: the miner keeps the best patterns and hands them to sink at the end, it does not stop early
+        Top_k top(this->top_k, this->theta);
+        int max_number_of_pattern = this->max_number_of_pattern;
+        if (this->top_k > 0) {
+            ctx.top = &top;
+            max_number_of_pattern = 0;
+        }
 
     	try{
     	    // Builds mdd structure in datab_MDD and create mdd_q for pattern mining algorithm
-            Build_MDD(datab_MDD, mdd_q,
-                      &(this->lgapi), &(this->ugapi),
-                      &(this->lspni),
-                      &(this->uavri), &(this->lavri), // Note that the order is other way around
-                      &(this->umedi), &(this->lmedi),
-                      &(this->lgap), &(this->ugap),
-                      &(this->lavr), &(this->uavr),
-                      &(this->lspn),
-                      &(this->lmed), &(this->umed),
-                      &(this->num_minmax),
-                      &(this->num_avr),
-                      &(this->num_med),
-                      &(this->tot_gap),
-                      &(this->tot_spn),
-                      &(this->tot_avr),
-                      this->M, this->N, this->L,
-                      this->num_att, &(this->max_attrs), &(this->min_attrs),
-                      &(this->items),
-                      &(this->attrs));
+            // (with a kept MDD only its initial patterns are copied, mining uses them up)
+            if (this->mdd) {
+                for (int i = 0; i < this->L; i++)
+                    if (this->mdd->dfs_q[i] != NULL)
+                        (*mdd_q)[i] = Copy_patt(this->mdd->dfs_q[i], &mdd_arena);
+            } else {
+                datab_MDD->reserve(num_events);
+                Build_MDD(datab_MDD, &mdd_arena, &layout, mdd_q,
+                          &(this->lgapi), &(this->ugapi),
+                          &(this->lspni),
+                          &(this->uavri), &(this->lavri), // Note that the order is other way around
+                          &(this->umedi), &(this->lmedi),
+                          &(this->lgap), &(this->ugap),
+                          &(this->lavr), &(this->uavr),
+                          &(this->lspn),
+                          &(this->lmed), &(this->umed),
+                          &(this->num_minmax),
+                          &(this->num_avr),
+                          &(this->num_med),
+                          &(this->tot_gap),
+                          &(this->tot_spn),
+                          &(this->tot_avr),
+                          this->M, this->N, this->L,
+                          this->num_att, &(this->max_attrs), &(this->min_attrs),
+                          &(this->items),
+                          &(this->attrs));
+            }
         }
         catch(exception& e){
             throw e;
@@ -67,7 +112,8 @@ namespace patterns {
 
         try{
             // Run frequent mining
-            results = Freq_miner(mdd_q,
+            if (this->parallel)
+                num_patterns = Freq_miner_parallel(&ctx, mdd_q,
                                  &(this->uspni), &(this->lspni),
                                  &(this->uavri), &(this->lavri),
                                  &(this->umedi), &(this->lmedi),
@@ -81,26 +127,93 @@ namespace patterns {
                                  &(this->tot_avr),
                                  this->theta,
                                  this->L,
-                                 this->max_number_of_pattern);
+                                 max_number_of_pattern);
+            else if (this->top_k > 0)
+                num_patterns = Freq_miner_top(&ctx, mdd_q,
+                                 &(this->uspni), &(this->lspni),
+                                 &(this->uavri), &(this->lavri),
+                                 &(this->umedi), &(this->lmedi),
+                                 &(this->lavr), &(this->uavr),
+                                 &(this->lspn), &(this->uspn),
+                                 &(this->lmed), &(this->umed),
+                                 &(this->num_minmax),
+                                 &(this->num_avr),
+                                 &(this->num_med),
+                                 &(this->tot_spn),
+                                 &(this->tot_avr),
+                                 this->theta,
+                                 this->L);
+            else
+                num_patterns = Freq_miner(&ctx, mdd_q,
+                                 &(this->uspni), &(this->lspni),
+                                 &(this->uavri), &(this->lavri),
+                                 &(this->umedi), &(this->lmedi),
+                                 &(this->lavr), &(this->uavr),
+                                 &(this->lspn), &(this->uspn),
+                                 &(this->lmed), &(this->umed),
+                                 &(this->num_minmax),
+                                 &(this->num_avr),
+                                 &(this->num_med),
+                                 &(this->tot_spn),
+                                 &(this->tot_avr),
+                                 this->theta,
+                                 this->L,
+                                 max_number_of_pattern);
 
-            // Delete MDD nodes
-            for (int i=0; i < (*datab_MDD).size(); i++){
-                if ((*datab_MDD)[i]!=NULL)
-                    (*datab_MDD)[i]->~Node();
-            }
-            // Delete vectors defined in freq_miner.cpp
-            std::vector<bool>().swap(indic_vec);
-	        std::vector<vector<int>>().swap(result);
+            if (this->top_k > 0)
+                num_patterns = top.Flush(&sink);
+
+            // MDD nodes and all patterns are released with mdd_arena and ctx
 	        // Delete pointers
             delete datab_MDD;
             // mdd_q, the queue should be empty after calling Freq_miner() with all its patterns get popped
             delete mdd_q;
 
-            return results;
+            this->interrupted = ctx.interrupted;
+            return num_patterns;
         }
         catch(exception& e){
             throw e;
         }
     }
 
+    int Seq2pat::add_sequence(const std::vector<int>& seq_items, const std::vector<std::vector<int> >& seq_attrs)
+    {
+        if (!this->mdd) {
+            this->mdd = std::make_shared<Mdd_db>();
+            this->mdd->lay = Make_layout(this->num_att, &(this->num_minmax), &(this->num_avr), &(this->num_med),
+                                         &(this->tot_spn), &(this->tot_avr), &(this->lmedi), &(this->umedi));
+            this->mdd->dfs_q.assign(this->L, NULL);
+        }
+        // sequence i is items[i] as for mine() from scratch, removed sequences stay there (empty)
+        this->items.push_back(seq_items);
+        if (this->attrs.size() < seq_attrs.size())
+            this->attrs.resize(seq_attrs.size());
+        for (int att = 0; att < this->attrs.size(); att++) {
+            this->attrs[att].resize(this->items.size());
+            if (att < seq_attrs.size())
+                this->attrs[att].back() = seq_attrs[att];
+        }
+        this->N = this->items.size();
+        if (this->M < seq_items.size())
+            this->M = seq_items.size();
+
+        Popl_seq(&(this->mdd->nodes), &(this->mdd->arena), &(this->mdd->lay), &(this->mdd->dfs_q), this->N - 1, this->L,
+                 this->num_att, &(this->max_attrs), &(this->min_attrs), &(this->items), &(this->attrs),
+                 &(this->lgapi), &(this->ugapi), &(this->lspni), &(this->lmedi), &(this->umedi), &(this->lavri), &(this->uavri),
+                 &(this->lgap), &(this->ugap), &(this->lavr), &(this->uavr), &(this->lspn), &(this->lmed), &(this->umed),
+                 &(this->num_minmax), &(this->num_avr), &(this->num_med), &(this->tot_gap), &(this->tot_spn), &(this->tot_avr));
+        return this->N;
+    }
+
+    void Seq2pat::remove_sequence(int id)
+    {
+        if (!this->mdd || id < 1 || id > this->items.size())
+            return;
+        Remove_seq(&(this->mdd->nodes), &(this->mdd->arena), &(this->mdd->dfs_q), id, this->L, &(this->items[id - 1]));
+        std::vector<int>().swap(this->items[id - 1]);
+        for (int att = 0; att < this->attrs.size(); att++)
+            std::vector<int>().swap(this->attrs[att][id - 1]);
+    }
+
 }
@@ -7,10 +7,19 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+struct Mdd_db;
 
 // This class holds all the parameters
 // and the method to perform mining
 namespace patterns {
+    // Receives every pattern as soon as it is found: the items followed by the number of sequences
+    // that contain it. Return false to stop mining.
+    typedef std::function<bool(const std::vector<int>& pattern)> pattern_sink_t;
+
     class Seq2pat {
         public:
 
@@ -27,6 +36,12 @@ namespace patterns {
             std::vector<std::vector<std::vector<int> > > attrs;
             std::vector<int> max_attrs, min_attrs;
             int max_number_of_pattern;
+            int top_k;                                            // keep only the top_k most frequent patterns, theta rises as they are found (0 off)
+            bool parallel;                                        // mine the subtrees of the first items in parallel (same result)
+            const std::atomic<bool>* cancel;                      // if set to true while mining, mine() returns the patterns found so far
+            int max_mine_millis;                                  // same if mining takes longer than this (0 no limit)
+            bool interrupted;                                     // set by mine() if it stopped because of cancel or max_mine_millis
+            std::shared_ptr<Mdd_db> mdd;                          // kept MDD if sequences are added with add_sequence()
 
             // Class object
             Seq2pat();
@@ -34,6 +49,14 @@ namespace patterns {
 
             // Mining function
             std::vector< std::vector<int> > mine();
+            // Same patterns in the same order, handed to sink instead of collected. Returns how many.
+            int mine(pattern_sink_t sink);
+
+            // Sliding windows: instead of setting items and attrs, add and remove sequences between calls to mine().
+            // The MDD is kept, only the arcs of added or removed sequences are built or taken out. Set L (largest
+            // item ever added) and the constraints before the first sequence. Returns the id of the sequence.
+            int add_sequence(const std::vector<int>& seq_items, const std::vector<std::vector<int> >& seq_attrs);
+            void remove_sequence(int id);
     };
 }
 
@@ -0,0 +1,57 @@
+// Micro-benchmark of getting log entries into the history: entries arrive out of order, are sorted
+// (HistoryEntry compares time and hash) and merged into the columnar store in batches.
+//
+//   g++ -std=c++20 -O2 -I. -Ibackend benchmark/history_insert.cpp backend/seq2pat.cpp -o history_insert -ltbb -lncurses
+//   ./history_insert [number of entries, 10000000] [number of batches, 10]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "history.hpp"
+
+bool verbose = false;
+bool fullHistory = false;
+
+int main(int argc, char *argv[]) {
+    int numEntries = (argc > 1) ? atoi(argv[1]) : 10000000;
+    int numBatches = (argc > 2) ? std::max(1, atoi(argv[2])) : 10;
+
+    history_t history;
+    file_entry_t log_file = { .filename = "/benchmark/svc.log" };
+    log_file.originator = history.internOriginator(log_file.filename);
+    char buf[128];
+    for (int i = 0; i < numEntries; i++) {
+        snprintf(buf, sizeof(buf), "2024-%02d-%02d %02d:%02d:%02d: INFO job %d", 1 + (i / 2000000) % 12, 1 + (i / 86400) % 28,
+                 (i / 3600) % 24, (i / 60) % 60, i % 60, i % 997);
+        addEntry(&log_file.linear_event_list, buf, &log_file);
+    }
+    std::vector<HistoryEntry *> entries;
+    for (auto &entry : log_file.linear_event_list)
+        entries.push_back(&entry);
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(1));
+
+    // every batch is a random part of the history, later batches go in between the entries already there
+    auto startTime = std::chrono::steady_clock::now();
+    double sortSeconds = 0;
+    size_t batchSize = (entries.size() + numBatches - 1) / numBatches;
+    for (size_t first = 0; first < entries.size(); first += batchSize) {
+        std::vector<HistoryEntry *> run(entries.begin() + first, entries.begin() + std::min(entries.size(), first + batchSize));
+        auto sortTime = std::chrono::steady_clock::now();
+        std::sort(run.begin(), run.end(), [](const HistoryEntry *a, const HistoryEntry *b) { return *a < *b; });
+        sortSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - sortTime).count();
+        // same as toRows(), which would also release the parsed entries of the later batches
+        std::vector<history_t::row_t> rows(run.size());
+        for (size_t i = 0; i < run.size(); i++) {
+            uint32_t event = history.internEvent(run[i]->getValue());
+            rows[i] = history_t::row_t{ run[i]->getTime(), run[i]->getHash(), event, log_file.originator, typeFromString(run[i]->getType()),
+                                        history.internLabel(event, log_file.originator) };
+        }
+        history.merge(rows);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    fprintf(stdout, "inserted %zu of %d entries in %d batches in %.2fs [%.0f inserts / s], sorting took %.2fs\n",
+            history.size(), numEntries, numBatches, seconds, numEntries / std::max(seconds, 1e-9), sortSeconds);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Micro-benchmark of mining with span and median constraints, the constraints that keep information in the
+// MDD nodes (Node::attr) and in every pattern (Pattern::info). LoCo itself only uses a gap constraint.
+// 6 random sequences of 30 event types, attribute 0 is a time stamp, attribute 1 a value 0..100:
+//   gap <= 12 and span 4..40 on the time, median of the values 30..70
+//
+//   g++ -std=c++20 -O2 -Ibackend benchmark/mdd_constraints.cpp backend/seq2pat.cpp -o mdd_constraints -ltbb
+//   ./mdd_constraints [sequence length, 4000] [max number of pattern, 20000, 0 all] [repeats, 3]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "seq2pat.hpp"
+
+int main(int argc, char *argv[]) {
+    int len = (argc > 1) ? atoi(argv[1]) : 4000;
+    int maxNumberOfPattern = (argc > 2) ? atoi(argv[2]) : 20000;
+    int repeats = (argc > 3) ? atoi(argv[3]) : 3;
+
+    double best = 1e9;
+    size_t numPattern = 0, check = 0;
+    for (int rep = 0; rep < repeats; rep++) {
+        // same data every time, some events repeat every 7th position so there is something to find
+        std::mt19937 random(7);
+        int N = 6, L = 30, time = 0;
+        std::vector<std::vector<int> > items(N), times(N), values(N);
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < len; j++) {
+                items[i].push_back(1 + (j % 7 == 0 ? j % 5 : random() % L));
+                times[i].push_back(time += 1 + random() % 3);
+                values[i].push_back(random() % 101);
+            }
+        }
+        patterns::Seq2pat algo;
+        algo.M = len;
+        algo.N = N;
+        algo.L = L;
+        algo.items = items;
+        algo.theta = 4;
+        algo.attrs = { times, values };
+        algo.num_att = 2;
+        algo.max_attrs = { time, 100 };
+        algo.min_attrs = { 0, 0 };
+        algo.tot_gap = { 0 };
+        algo.ugapi = { 0 };
+        algo.ugap = { 12 };
+        algo.tot_spn = { 0 };
+        algo.uspni = { 0 };
+        algo.uspn = { 40 };
+        algo.lspni = { 0 };
+        algo.lspn = { 4 };
+        algo.num_minmax = { 2, 0 };
+        algo.lmedi = { 1 };
+        algo.lmed = { 30 };
+        algo.umedi = { 1 };
+        algo.umed = { 70 };
+        algo.num_med = { 0, 2 };
+        algo.num_avr = { 0, 0 };
+        algo.max_number_of_pattern = maxNumberOfPattern;
+
+        auto startTime = std::chrono::steady_clock::now();
+        std::vector<std::vector<int> > result = algo.mine();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        best = std::min(best, seconds);
+        // a hash of all pattern, it has to stay the same if the miner changes
+        numPattern = result.size();
+        check = 0;
+        for (auto &pattern : result)
+            for (int v : pattern)
+                check = check * 1000003 + v;
+    }
+    fprintf(stdout, "length %d: %zu pattern (hash %zx), best of %d: %.3fs\n", len, numPattern, check, repeats, best);
+    return 0;
+}
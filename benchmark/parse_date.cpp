@@ -0,0 +1,58 @@
+// Micro-benchmark of the two timestamp parsers: parseDateFixed (fast path for "Y-m-d H:M:S") and
+// parseDateLocale (std::get_time, the fallback). Both read the same synthetic log lines.
+//
+//   g++ -std=c++20 -O2 -I. -Ibackend benchmark/parse_date.cpp backend/seq2pat.cpp -o parse_date -ltbb -lncurses
+//   ./parse_date [number of lines, 1000000]
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "history.hpp"
+
+bool verbose = false;
+bool fullHistory = false;
+
+int main(int argc, char *argv[]) {
+    int numLines = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    // one log line per second, some with fractional seconds
+    std::vector<std::string> lines(numLines);
+    char buf[128];
+    for (int i = 0; i < numLines; i++) {
+        int s = i % 60, m = (i / 60) % 60, h = (i / 3600) % 24, d = 1 + (i / 86400) % 28;
+        if (i % 4 == 0)
+            snprintf(buf, sizeof(buf), "2024-03-%02d %02d:%02d:%02d.%03d: INFO story A step %d", d, h, m, s, i % 1000, i % 16);
+        else
+            snprintf(buf, sizeof(buf), "2024-03-%02d %02d:%02d:%02d: INFO story A step %d", d, h, m, s, i % 16);
+        lines[i] = buf;
+    }
+
+    // sum up the result so the compiler cannot drop the calls (the sums differ, get_time drops fractional seconds)
+    auto run = [&](const char *name, auto parse) {
+        int64_t check = 0;
+        int failed = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < numLines; i++) {
+            std::tm t;
+            int64_t nanos = 0;
+            if (!parse(std::string_view(lines[i]), &t, &nanos)) {
+                failed++;
+                continue;
+            }
+            check += toEpochNanos(t, nanos);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        fprintf(stdout, "%-16s %9d lines in %.3fs [%.2fM lines / s], failed: %d, checksum: %lld\n", name, numLines, seconds,
+                numLines / std::max(seconds, 1e-9) / 1e6, failed, (long long)check);
+    };
+    run("parseDateLocale", [](std::string_view str, std::tm *t, int64_t *nanos) {
+        *nanos = 0; // get_time has no fractional seconds
+        return parseDateLocale(str, t);
+    });
+    run("parseDateFixed", [](std::string_view str, std::tm *t, int64_t *nanos) {
+        return parseDateFixed(str, t, nanos);
+    });
+    return 0;
+}
@@ -1,16 +1,31 @@
+#pragma once
+
 #include <string>
 #include <filesystem>
 #include <map>
+#include <set>
 #include <list>
-#include <boost/intrusive/set.hpp>
+#include <unordered_set>
+#include <deque>
 #include <boost/algorithm/string.hpp>
 #include <vector>
 #include <functional>
 #include <cassert>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <atomic>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include "backend/seq2pat.hpp"
+#include "history_store.hpp"
 #include <ncurses.h>
 
 extern bool verbose;
+extern bool fullHistory; // import whole log files instead of the last READSIZE bytes
 
 
 typedef struct {
@@ -20,10 +35,6 @@ typedef struct {
     std::string value; // string value of entry
 } entry_t;
 
-using namespace boost::intrusive;
-
-
-
 
 #define min3(a,b,c) std::min(std::min(a, b), c) 
 
@@ -86,62 +97,81 @@ int editDistDP(const std::string &s1, const std::string &s2) {
     return dp[m][n];
 }
 
-// a simple data structure for storing login line information
-class HistoryEntry : public set_base_hook<optimize_size<true> > {
-    std::tm t_; // when this entry was written (log time)
-    std::string originator_; // what log file it came from
+// Days since 1970-01-01 for a date in the proleptic Gregorian calendar (Howard Hinnant's days_from_civil).
+// We treat the log time as wall clock time, no timezone database involved.
+inline int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+// nanoseconds since epoch for a parsed log time
+inline int64_t toEpochNanos(const std::tm &t, int64_t nanos = 0) {
+    // normalize month overflow the same way mktime would
+    int64_t year = t.tm_year + 1900 + t.tm_mon / 12;
+    int mon = t.tm_mon % 12;
+    if (mon < 0) {
+        mon += 12;
+        year--;
+    }
+    int64_t days = daysFromCivil(year, mon + 1, 1) + t.tm_mday - 1;
+    int64_t seconds = days * 86400 + t.tm_hour * 3600 + t.tm_min * 60 + t.tm_sec;
+    return seconds * 1000000000LL + nanos;
+}
+
+// back to calendar time (for printing)
+inline std::tm fromEpochNanos(int64_t time) {
+    int64_t seconds = time / 1000000000LL;
+    if (time % 1000000000LL < 0)
+        seconds--;
+    time_t tt = (time_t)seconds;
+    std::tm t = {};
+    gmtime_r(&tt, &t);
+    return t;
+}
+
+// FNV-1a over value and originator, used to order entries with the same time stamp
+inline uint64_t hashEntry(const std::string &value, const std::string &originator) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : value)
+        h = (h ^ c) * 1099511628211ULL;
+    h = (h ^ 0xff) * 1099511628211ULL; // separator, "ab"+"c" != "a"+"bc"
+    for (unsigned char c : originator)
+        h = (h ^ c) * 1099511628211ULL;
+    return h;
+}
+
+// a simple data structure for storing login line information, used while parsing a log file
+// (the merged history keeps its entries in a HistoryStore)
+class HistoryEntry {
+    int64_t time_; // when this entry was written (log time), nanoseconds since epoch
+    uint64_t hash_; // hash of value and originator, tie-breaker for entries with the same time
+    uint32_t originator_; // what log file it came from, id in the originator table of the history
     std::string type_; // INFO, DEBUG, WARN, etc.
     std::string value_; // string value of entry
 
     public:
-    set_member_hook<> member_hook_;
-
-    HistoryEntry(std::tm t, std::string originator, std::string type, std::string value) : t_(t), originator_(originator), type_(type), value_(value) {}
+    HistoryEntry(int64_t time, uint32_t originator, uint64_t hash, std::string type, std::string value) : time_(time), hash_(hash), originator_(originator), type_(type), value_(value) {
+    }
+    // sort by time first, entries with the same time are sorted by hash (and by content if the hash collides)
     friend bool operator< (const HistoryEntry &a, const HistoryEntry &b) {
-        std::tm at = a.t_; // we need a non-const version because mktime will store something inside
-        std::tm bt = b.t_;
-        time_t tat = std::mktime(&at); // in case this is expensive to it only once
-        time_t tbt = std::mktime(&bt);
-        // if the two times are equal we should compare the content as well (sort by value string)
-        if (tat == tbt) { // std::mktime(&at) == std::mktime(&bt)) {
-            // TODO: we could add sorting here for events coming in from different originators (at the same time)
-            if (a.value_ == b.value_)
-                return a.originator_ < b.originator_;
-            return a.value_ < b.value_;
-        }
-        return tat < tbt; // std::mktime(&at) < std::mktime(&bt);
+        if (a.time_ != b.time_)
+            return a.time_ < b.time_;
+        if (a.hash_ != b.hash_)
+            return a.hash_ < b.hash_;
+        if (a.value_ == b.value_)
+            return a.originator_ < b.originator_;
+        return a.value_ < b.value_;
     }
     friend bool operator> (const HistoryEntry &a, const HistoryEntry &b) {
-        std::tm at = a.t_;
-        std::tm bt = b.t_;
-        time_t tat = std::mktime(&at); // in case this is expensive to it only once
-        time_t tbt = std::mktime(&bt);
-        if (tat == tbt) { // std::mktime(&at) == std::mktime(&bt)) {
-            if (a.value_ == b.value_)
-                return a.originator_ > b.originator_;
-            return a.value_ > b.value_;
-        }
-        return tat > tbt; // std::mktime(&at) > std::mktime(&bt);
+        return b < a;
     }
     friend bool operator== (const HistoryEntry &a, const HistoryEntry &b) {
-        std::tm at = a.t_;
-        std::tm bt = b.t_;
-        time_t tat = std::mktime(&at); // in case this is expensive to it only once
-        time_t tbt = std::mktime(&bt);
         // two events are only equal if they have the same time and the same content (value)
-        return (tat == tbt) && (a.value_ == b.value_) && (a.originator_ == b.originator_);
-        //return (std::mktime(&at) == std::mktime(&bt)) && (a.value_ == b.value_);
-    }
-    std::string toString() {
-        std::stringstream bla; 
-        bla << std::put_time(&t_, "%Y-%m-%d %H:%M:%S");
-        std::string erg = bla.str() + std::string(": [") + originator_ + std::string("][") + type_ + std::string("] ") + value_;
-        return erg;
-    }
-    std::string getOriginator() {
-        // instead return the filename only (assume that path is not important)
-        boost::filesystem::path p(originator_);
-        return p.stem().c_str();
+        return (a.time_ == b.time_) && (a.hash_ == b.hash_) && (a.value_ == b.value_) && (a.originator_ == b.originator_);
     }
     std::string getType() {
         return type_;
@@ -149,394 +179,985 @@ class HistoryEntry : public set_base_hook<optimize_size<true> > {
     std::string getValue() {
         return value_;
     }
-    std::tm getTime() {
-        return t_;
+    int64_t getTime() {
+        return time_;
+    }
+    uint64_t getHash() {
+        return hash_;
+    }
+    uint32_t getOriginatorId() {
+        return originator_;
     }
 };
 
-typedef set< HistoryEntry, compare<std::greater<HistoryEntry> > > history_t;
+typedef HistoryStore history_t;
+
+// a row of the history as 'Y-m-d H:M:S: [originator][type] value'
+std::string toString(const history_t *history, size_t row) {
+    std::stringstream bla;
+    std::tm t = fromEpochNanos(history->time[row]);
+    bla << std::put_time(&t, "%Y-%m-%d %H:%M:%S");
+    bla << ": [" << history->originators[history->originator[row]] << "][" << entry_type_names[history->type[row]] << "] " << history->value(row);
+    return bla.str();
+}
+
+// the filename only (assume that path is not important), computed once when the log file is added
+const std::string &originatorStem(const history_t *history, uint32_t originator) {
+    return history->originator_stems[originator];
+}
 
 // we only need to keep track of path/filename and the last write time
 typedef struct {
     std::string filename;
     std::filesystem::file_time_type last_write_time;
     std::filesystem::file_time_type last_imported_time; // initially set this to before the last write time
-    std::vector<HistoryEntry> linear_event_list; // store events as they are imported, sorted into a tree in history_t
+    std::deque<HistoryEntry> linear_event_list; // events parsed but not yet merged into history_t
     int num_imported;
-
+    int64_t num_entries; // events parsed from this file so far
+    // where to continue reading on the next updateHistory call
+    int64_t last_offset; // bytes consumed so far, always at the start of a line
+    uint64_t inode;      // fingerprint of the file we read last time, detects rotation
+    int64_t last_size;   // file size at the last import, detects truncation
+    uint32_t originator; // id of this file in the originator table of the history
 } file_entry_t;
 
-std::tuple<std::tm, bool, std::string> parseDate(std::string str) {
+// read exactly n digits starting at str[pos], returns -1 if one of them is not a digit
+inline int parseDigits(std::string_view str, size_t pos, int n) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned d = (unsigned char)str[pos + i] - '0';
+        if (d > 9)
+            return -1;
+        v = v * 10 + d;
+    }
+    return v;
+}
+
+// Fast path for the common "%Y-%m-%d %H:%M:%S" prefix with optional fractional seconds ("2019-04-12 12:12:01.123").
+// Works directly on the line, no allocations, no locale. Returns false if the line does not start with this format.
+bool parseDateFixed(std::string_view str, std::tm *t, int64_t *nanos) {
+    if (str.size() < 19 || str[4] != '-' || str[7] != '-' || str[10] != ' ' || str[13] != ':' || str[16] != ':')
+        return false;
+    int year = parseDigits(str, 0, 4);
+    int month = parseDigits(str, 5, 2);
+    int day = parseDigits(str, 8, 2);
+    int hour = parseDigits(str, 11, 2);
+    int minute = parseDigits(str, 14, 2);
+    int second = parseDigits(str, 17, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+        return false;
+    int64_t frac = 0;
+    if (str.size() > 20 && (str[19] == '.' || str[19] == ',') && (unsigned)((unsigned char)str[20] - '0') <= 9) {
+        int64_t scale = 100000000;
+        for (size_t i = 20; i < str.size() && (unsigned)((unsigned char)str[i] - '0') <= 9; i++) {
+            frac += (str[i] - '0') * scale; // digits beyond nanoseconds add nothing
+            scale /= 10;
+        }
+    }
+    *t = std::tm{};
+    t->tm_year = year - 1900;
+    t->tm_mon = month - 1;
+    t->tm_mday = day;
+    t->tm_hour = hour;
+    t->tm_min = minute;
+    t->tm_sec = second;
+    *nanos = frac;
+    return true;
+}
+
+// Slow fallback using the locale and std::get_time, also understands "Sat Sep  7 11:00:04 PM CEST 2024".
+bool parseDateLocale(std::string_view str, std::tm *t) {
+    std::istringstream ss{std::string(str)};
+    *t = {};
+    ss.imbue(std::locale(""));
+    ss >> std::get_time(t, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail() || str.size() < 16) {
+        // try again with a different format "Sat Sep  7 11:00:04 PM CEST 2024"
+        ss = std::istringstream{std::string(str)};
+        *t = {};
+        ss >> std::get_time(t, "%a %b %d %I:%M:%S %p %Z %Y");  // this fails because %Z is not part of get_time, at least for CEST
+        if (ss.fail() || str.size() < 16) {
+            // skip this event, could not read the log time
+            //if (verbose)
+            //    fprintf(stdout, "PARSE FAILED: \"%s\"\n", str.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+std::tuple<int64_t, bool, std::string> parseDate(std::string_view str) {
     // split string into date (beginning) and rest
     int spaces = 0;
-    std::string front("");
-    std::string rest("");
-    for (int i = 0; i < str.size(); i++) {
+    std::string_view front;
+    std::string_view rest;
+    for (size_t i = 0; i < str.size(); i++) {
         if (str[i] == ' ')
             spaces++;
         if (spaces == 2) {
             front = str.substr(0, i);
-            rest = str.substr(i+1); //  + std::string("\"") + str + std::string("\"");
-            boost::trim_left(rest);
+            rest = str.substr(i+1);
+            while (!rest.empty() && std::isspace((unsigned char)rest.front()))
+                rest.remove_prefix(1);
             break;
         }
     }
     if (front.size() == 0) {
-        return std::make_tuple(std::tm{}, false, std::string());
+        return std::make_tuple(0, false, std::string());
     }
 
-    std::istringstream ss(str);
     std::tm t = {};
-    ss.imbue(std::locale(""));
-    ss >> std::get_time(&t, "%Y-%m-%d %H:%M:%S");
-    if (ss.fail() || str.size() < 16) {
-        // try again with a different format "Sat Sep  7 11:00:04 PM CEST 2024"
-        ss = std::istringstream(str);
-        t = {};
-        ss >> std::get_time(&t, "%a %b %d %I:%M:%S %p %Z %Y");  // this fails because %Z is not part of get_time, at least for CEST
-        if (ss.fail() || str.size() < 16) {
-            // skip this event, could not read the log time
-            //if (verbose)
-            //    fprintf(stdout, "PARSE FAILED: \"%s\"\n", str.c_str());
-            return std::make_tuple(std::tm{}, false, std::string());
-        }
-    }
-    return std::make_tuple(t, true, rest);
+    int64_t nanos = 0;
+    if (!parseDateFixed(str, &t, &nanos) && !parseDateLocale(str, &t))
+        return std::make_tuple(0, false, std::string());
+    return std::make_tuple(toEpochNanos(t, nanos), true, std::string(rest));
 }
 
-bool addEntry(std::vector<HistoryEntry> *values, std::string line, std::string originator) {
+bool addEntry(std::deque<HistoryEntry> *values, std::string_view line, const file_entry_t *log_file) {
     // lets parse the date field and the type fields
     // this is tricky because the format for unstructured logs is not 'nice'
     //fprintf(stdout, "BLA: \"%s\"\n", line.substr(0,16).c_str());
     // line = std::string("Sat Sep  7 11:00:04 PM CEST 2024");
     std::string type = "UNKNOWN";
-    if (line.find("INFO") != std::string::npos) {
+    if (line.find("INFO") != std::string_view::npos) {
         type = "INFO";
     }
-    if (line.find("DEBUG") != std::string::npos) {
+    if (line.find("DEBUG") != std::string_view::npos) {
         type = "DEBUG";
     }
-    if (line.find("ERROR") != std::string::npos) {
+    if (line.find("ERROR") != std::string_view::npos) {
         type = "ERROR";
     }
-    if (line.find("WARNING") != std::string::npos) {
+    if (line.find("WARNING") != std::string_view::npos) {
         type = "WARNING";
     }
 
-    std::tuple<std::tm, bool, std::string> ret = parseDate(line);
+    std::tuple<int64_t, bool, std::string> ret = parseDate(line);
     if (!std::get<1>(ret)) {
         // TODO: failed to detect the date for this line, we could use the last modification time as a worst case thing here?
         // for now just ignore this line
         return false; // do nothing
     }
-    std::tm t = std::get<0>(ret);
-    // parsed time is now:
-    //std::stringstream bla; 
-    //bla << std::put_time(&t, "%c");
-    //if (verbose)
-    //    fprintf(stdout, "WORKING %s line from %s to add is: %s\n", bla.str().c_str(), originator.c_str(), line.c_str());
+    int64_t t = std::get<0>(ret); // nanoseconds since epoch
 
-    //std::vector<HistoryEntry> values;
-    values->push_back(HistoryEntry(t, originator, type, std::get<2>(ret)));
+    values->push_back(HistoryEntry(t, log_file->originator, hashEntry(std::get<2>(ret), log_file->filename), type, std::get<2>(ret)));
     return true;
 }
 
-// how many bytes will we read from the end of the file?
+// how many bytes will we read from the end of the file (unless fullHistory is set)?
 #define READSIZE (2000*4096)
 std::vector<std::string> spinner = std::vector<std::string>{"⣾ ", "⣽ ", "⣻ ", "⢿ ", "⡿ ", "⣟ ", "⣯ ", "⣷ "};
 
-void updateHistory(history_t *history, file_entry_t *log_file) {
+// statistics for a single parseLogFile call
+typedef struct {
+    int num_parsed;       // lines we could read a date from
+    int num_skipped;      // lines we could not parse
+    int64_t num_bytes;    // bytes consumed
+    double seconds;       // time spend parsing
+} import_stats_t;
+
+// Read new lines of a log file into its linear_event_list. We remember how many bytes we consumed
+// so that the next call only parses what was appended since then. If the file was rotated
+// (new inode) or truncated (smaller than before) we start reading it from the beginning again.
+// This only touches log_file, it can run in parallel for different files.
+import_stats_t parseLogFile(file_entry_t *log_file, bool showProgress = false) {
+    import_stats_t stats = { .num_parsed = 0, .num_skipped = 0, .num_bytes = 0, .seconds = 0 };
+    auto startTime = std::chrono::steady_clock::now();
+
     // check if we need to open this file
     std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(log_file->filename);
     if (log_file->last_imported_time >= last_write_time)
-        return; // nothing to be done
-    // read the last 4096 byte from log_file.filename
-    FILE *fp;
-    int lastXBytes = READSIZE; // should correspond to block size on disk, but no alignment!    
+        return stats; // nothing to be done
 
-    if ((fp = fopen(log_file->filename.c_str(), "rb")) == NULL) {
+    // map the file into memory and walk it line by line in place (no copies of the buffer)
+    int fd = open(log_file->filename.c_str(), O_RDONLY);
+    if (fd < 0) {
         fprintf(stderr, "Error: could not open file %s\n", log_file->filename.c_str());
-        return;
+        return stats;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "Error: could not stat file %s\n", log_file->filename.c_str());
+        close(fd);
+        return stats;
+    }
+    int64_t fileSize = st.st_size; // 64bit, files can be larger than 2GB
+    if (log_file->last_offset > 0 && ((uint64_t)st.st_ino != log_file->inode || fileSize < log_file->last_size)) {
+        if (verbose)
+            fprintf(stdout, "%s was rotated or truncated, read again from the start\n", log_file->filename.c_str());
+        log_file->last_offset = 0;
+    }
+    log_file->inode = st.st_ino;
+    log_file->last_size = fileSize;
+    if (fileSize == 0 || fileSize == log_file->last_offset) {
+        close(fd);
+        log_file->last_imported_time = last_write_time;
+        return stats;
     }
-    fseek(fp, 0L, SEEK_END);
-    int fileSize = ftell(fp);
-    fseek(fp, 0L, SEEK_SET);
+    char *buf = (char *)mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference to the file
+    if (buf == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map file %s\n", log_file->filename.c_str());
+        return stats;
+    }
+    madvise(buf, fileSize, MADV_SEQUENTIAL);
 
-    if (fileSize > lastXBytes) {
-        fseek(fp, -lastXBytes, SEEK_END);
+    // continue where we stopped last time, on the first import only look at the tail of the file
+    // (with fullHistory we start at the beginning)
+    int64_t startOffset = log_file->last_offset;
+    if (startOffset == 0 && !fullHistory && fileSize > READSIZE)
+        startOffset = fileSize - READSIZE;
+    const char *pos = buf + startOffset;
+    const char *end = buf + fileSize;
+    // we should ignore the first line in case we start in the middle of the file, should be a partial line
+    if (startOffset > 0 && buf[startOffset-1] != '\n') {
+        const char *nl = (const char *)memchr(pos, '\n', end - pos);
+        pos = (nl == NULL) ? end : nl + 1;
     }
-    char *buf = new char[READSIZE];
-    int bytesRead = fread(buf, sizeof(char), lastXBytes, fp);
-    fclose(fp);
-    //std::string lines = std::string(buf, bytesRead);
-    std::stringstream ss(std::string(buf, READSIZE));
-    std::string line;
-    // we should ignore the first line in case we have a large file,
-    if (fileSize > lastXBytes)
-        std::getline(ss, line, '\n'); // read and ignore the first line, should be a partial line
 
     // collect all the events in log_file->linear_event_list
     int numLinesParsedNow = 0;
     int numLinesNotParsedNow = 0;
-    if (verbose)
+    if (showProgress)
         fprintf(stdout, "\n");
-    while (std::getline(ss, line,'\n')) { // it should be required to create a new string here.
+    while (pos < end) {
+        const char *nl = (const char *)memchr(pos, '\n', end - pos);
+        if (nl == NULL)
+            break; // the last line is still being written, read it next time
         // process line now
-        if (addEntry(&log_file->linear_event_list, line, log_file->filename))
+        if (addEntry(&log_file->linear_event_list, std::string_view(pos, nl - pos), log_file))
             numLinesParsedNow++;
         else
             numLinesNotParsedNow++;
-        if (verbose && ((numLinesParsedNow + numLinesNotParsedNow) % 100) == 0) {
+        pos = nl + 1;
+        if (showProgress && ((numLinesParsedNow + numLinesNotParsedNow) % 100) == 0) {
             int spinner_c = numLinesParsedNow + numLinesNotParsedNow;
             // ("\033[A\033[2K\033[94;49m%s%d\033[37m [%.0f files / s] P %d S %d S %d [S %d]\033[39m\033[49m\n", spinner[(spinner_c)%len(spinner)], counter, (float64(counter))/time.Since(startTime).Seconds(), numPatients, numStudies, numSeries, counterError)
             fprintf(stdout, "\033[A\033[2K\033[94;49m%s%d\033[37m parsed %d lines, skipped %d\033[39m\033[49m\n", spinner[(spinner_c/100)%(spinner.size())].c_str(), spinner_c, numLinesParsedNow, numLinesNotParsedNow);
         }
     }
-    // add them to the history (should be sorted now)
-    typedef std::vector<HistoryEntry>::iterator VectIt;
-    for (VectIt it(log_file->linear_event_list.begin()), itend(log_file->linear_event_list.end()); it != itend; ++it) {
-        // we should insert if its not already in there (same date/time and value)
-        auto done = history->insert(*it);
-        if (done.second)
-            log_file->num_imported++;
-    }
+    stats.num_bytes = (pos - buf) - startOffset;
+    log_file->last_offset = pos - buf;
+    munmap(buf, fileSize);
 
     // now update the log_file time entry
     log_file->last_imported_time = last_write_time; // safe as now time instead?
-    return;
+
+    stats.num_parsed = numLinesParsedNow;
+    stats.num_skipped = numLinesNotParsedNow;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return stats;
 }
 
-// Print out the whole history, leave nothing out.
-void printHistory(history_t *history) {
-    history_t::reverse_iterator rbit(history->rbegin());
-    for (int i = 0; rbit != history->rend(); ++rbit, i++) {
-        fprintf(stdout, "H-%02d %s\n", i+1, (*rbit).toString().c_str());
+// Convert the new entries of a log file into rows of the history (this adds their strings to the arena).
+// Clears the parsed entries, from now on they live in the history.
+std::vector<history_t::row_t> toRows(history_t *history, file_entry_t *log_file, const std::vector<HistoryEntry *> &run) {
+    std::vector<history_t::row_t> rows(run.size());
+    uint32_t originator = log_file->originator;
+    for (size_t i = 0; i < run.size(); i++) {
+        uint32_t event = history->internEvent(run[i]->getValue());
+        rows[i] = history_t::row_t{ run[i]->getTime(), run[i]->getHash(), event, originator, typeFromString(run[i]->getType()), history->internLabel(event, originator) };
     }
+    log_file->num_entries += log_file->linear_event_list.size();
+    std::deque<HistoryEntry>().swap(log_file->linear_event_list);
+    return rows;
 }
 
-// Print out a specific section of the history with a symmetric window.
-std::vector<HistoryEntry> getLocalHistory(history_t *history, int location, int window=3) {
-    std::vector<HistoryEntry> entries;
-    history_t::reverse_iterator here(history->rbegin());
-    // history_t::iterator here(history->begin());
+// Import new lines of many log files into the history. Files are parsed in parallel into sorted runs,
+// the runs are combined with a parallel k-way merge (pairwise, log(k) rounds) before they go into the history.
+// Returns the number of entries added to the history.
+int updateHistory(history_t *history, std::vector<file_entry_t> *log_files) {
+    std::vector<import_stats_t> stats(log_files->size());
+    std::vector<std::vector<HistoryEntry *> > entries(log_files->size());
+    for (int i = 0; i < log_files->size(); i++) // before we go parallel, the table is not thread-safe
+        (*log_files)[i].originator = history->internOriginator((*log_files)[i].filename);
 
-    if (location < 0)
-        location = history->size() - location;
+    auto startTime = std::chrono::steady_clock::now();
+    tbb::parallel_for(size_t(0), log_files->size(), [&](size_t i) {
+        file_entry_t *log_file = &(*log_files)[i];
+        stats[i] = parseLogFile(log_file);
+        std::vector<HistoryEntry *> &run = entries[i];
+        for (size_t j = 0; j < log_file->linear_event_list.size(); j++)
+            run.push_back(&log_file->linear_event_list[j]);
+        auto cmp = [](const HistoryEntry *a, const HistoryEntry *b) { return *a < *b; };
+        if (!std::is_sorted(run.begin(), run.end(), cmp)) // logs are mostly written in order
+            std::sort(run.begin(), run.end(), cmp);
+    });
+    double parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (verbose) {
+        int64_t totalLines = 0;
+        for (int i = 0; i < log_files->size(); i++) {
+            totalLines += stats[i].num_parsed + stats[i].num_skipped;
+            if (stats[i].num_parsed + stats[i].num_skipped == 0)
+                continue;
+            fprintf(stdout, "Read %s: %d lines, skipped %d, %.1f MB in %.3fs [%.0f lines / s]\n", (*log_files)[i].filename.c_str(),
+                    stats[i].num_parsed, stats[i].num_skipped, stats[i].num_bytes / (1024.0 * 1024.0), stats[i].seconds,
+                    (stats[i].num_parsed + stats[i].num_skipped) / std::max(stats[i].seconds, 1e-9));
+        }
+        fprintf(stdout, "Parsed %zu files in %.3fs [%.0f lines / s]\n", log_files->size(), parseSeconds, totalLines / std::max(parseSeconds, 1e-9));
+    }
 
-    if (window < 0)
-        window = -window;
+    // strings go into the arena of the history (not thread-safe)
+    startTime = std::chrono::steady_clock::now();
+    std::vector<std::vector<history_t::row_t> > runs(log_files->size());
+    for (int i = 0; i < log_files->size(); i++)
+        runs[i] = toRows(history, &(*log_files)[i], entries[i]);
+    std::vector<std::vector<HistoryEntry *> >().swap(entries);
+    // std::merge below needs the runs in the order of the history, entries with the same time and hash were
+    // ordered by value above but the history orders them by event id
+    tbb::parallel_for(size_t(0), runs.size(), [&](size_t i) {
+        if (!std::is_sorted(runs[i].begin(), runs[i].end(), history_t::rowLess))
+            std::sort(runs[i].begin(), runs[i].end(), history_t::rowLess);
+    });
 
-    if (history->size() <= location + window) {
-        // do the best we can
-        window = history->size() - location - 1;
+    // k-way merge: merge neighboring runs in parallel until only one is left
+    runs.erase(std::remove_if(runs.begin(), runs.end(), [](const std::vector<history_t::row_t> &r) { return r.empty(); }), runs.end());
+    while (runs.size() > 1) {
+        std::vector<std::vector<history_t::row_t> > merged((runs.size() + 1) / 2);
+        tbb::parallel_for(size_t(0), merged.size(), [&](size_t i) {
+            if (2 * i + 1 == runs.size()) {
+                merged[i].swap(runs[2 * i]);
+                return;
+            }
+            merged[i].resize(runs[2 * i].size() + runs[2 * i + 1].size());
+            std::merge(runs[2 * i].begin(), runs[2 * i].end(), runs[2 * i + 1].begin(), runs[2 * i + 1].end(), merged[i].begin(), history_t::rowLess);
+        });
+        runs.swap(merged);
     }
-    if (history->size()-window < 0) {
-        // do the best we can
-        window = location - 1;
+    int numAdded = 0;
+    std::vector<int> added_per_originator;
+    if (runs.size() == 1)
+        numAdded = history->merge(runs[0], &added_per_originator);
+    // count per file what made it into the history (duplicates are dropped)
+    for (int i = 0; i < log_files->size(); i++) {
+        uint32_t originator = (*log_files)[i].originator;
+        if (originator < added_per_originator.size())
+            (*log_files)[i].num_imported += added_per_originator[originator];
     }
+    double mergeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (verbose)
+        fprintf(stdout, "Merged %d new entries into the history in %.3fs\n", numAdded, mergeSeconds);
 
-    std::advance(here, location - window);
-    for (int i = 0; i < window*2 + 1; i++) {
-        entries.push_back(*here);
-        ++here;
-    }
+    return numAdded;
+}
 
-    return entries;
+// Print out the whole history, leave nothing out.
+void printHistory(history_t *history) {
+    for (size_t i = 0; i < history->size(); i++) {
+        fprintf(stdout, "H-%02zu %s\n", i+1, toString(history, i).c_str());
+    }
 }
 
-// Print out a specific section of the history.
-std::vector<HistoryEntry> getLocalHistoryDuration(history_t *history, int location, int secondsAroundLocation=(60*24)) {
-    std::vector<HistoryEntry> entries;
-    history_t::iterator here(history->begin());
+// Get a specific section of the history with a symmetric window. The history is a sorted array,
+// finding location is constant time. A negative location counts from the end of the history.
+history_window_t getLocalHistory(history_t *history, int64_t location, int64_t window=3) {
+    int64_t n = history->size();
+    if (n == 0)
+        return history_window_t{ history, 0, 0 };
 
     if (location < 0)
-        location = history->size() - location;
-
-    std::advance(here, location);
-    std::tm mid_time = (*here).getTime();
-    mid_time.tm_sec -= secondsAroundLocation;
-    std::mktime(&mid_time); // should fix the overflow due to seconds subtracted
-    // go backwards
-    HistoryEntry stop(mid_time, std::string(""), std::string(""), std::string(""));
-    while (here != history->end() && stop < *here) {
-        entries.insert(entries.begin(), *here);
-        here++;
-    }
-    here = history->begin();
-    std::advance(here, location);
-    mid_time = (*here).getTime();
-    mid_time.tm_sec += secondsAroundLocation+1;
-    std::mktime(&mid_time); // should fix the overflow due to seconds added
-    // skip the mid location, already done in the previous loop
-    here = history->begin();
-    std::advance(here, location-1);
-
-    // go backwards
-    stop = HistoryEntry(mid_time, std::string(""), std::string(""), std::string(""));
-    while (here != history->begin() && stop > *here) {
-        entries.push_back(*here);
-        here--;
-    }
-
-    return entries;
+        location = n + location;
+    location = std::clamp(location, (int64_t)0, n - 1);
+
+    if (window < 0)
+        window = -window;
+
+    int64_t start = std::max((int64_t)0, location - window);
+    int64_t end = std::min(n, location + window + 1);
+    return history_window_t{ history, (size_t)start, (size_t)end };
 }
 
-// do a simple alignment and compute the best matching fit
-std::vector<int> computePatternShift(std::vector< std::vector<int> > erg) {
-    std::vector<int> result(erg.size());
-    if (erg.size() == 0)
-        return result;
+// Get a specific section of the history, all entries within secondsAroundLocation of the entry at location.
+history_window_t getLocalHistoryDuration(history_t *history, int64_t location, int secondsAroundLocation=(60*24)) {
+    int64_t n = history->size();
+    if (n == 0)
+        return history_window_t{ history, 0, 0 };
+
+    if (location < 0)
+        location = n + location;
+    location = std::clamp(location, (int64_t)0, n - 1);
+
+    // the time column is sorted, two binary searches give us the window
+    int64_t mid_time = history->time[location];
+    auto start = std::lower_bound(history->time.begin(), history->time.end(), mid_time - secondsAroundLocation * 1000000000LL);
+    auto end = std::upper_bound(start, history->time.end(), mid_time + secondsAroundLocation * 1000000000LL);
 
+    return history_window_t{ history, (size_t)(start - history->time.begin()), (size_t)(end - history->time.begin()) };
+}
+
+// do a simple alignment and compute the best matching fit of a pattern against the first pattern
+// (both with the number of matches as last element)
+int computePatternShift(const std::vector<int> &first, const std::vector<int> &pattern) {
     int bestShift = 0;
-    int bestShiftVal = 0;
-    result[0] = 0; // no shift with itself
-    for (int i = 1; i < erg.size(); i++) { // next pattern
-        // shift to the next pattern
-        int j = 0; // always compare with first pattern
-        int bestShift = 0;
-        float bestSumChange = 0.0;
-        int startShift = -(int)(erg[j].size()-1)/2;
-        for (int shift = startShift; shift < (int)erg[i].size()-1; shift++) { // do not count same pattern
-            int sumChange = 0;
-            int comparisons = 0;
-            for (int c = 0; c < erg[j].size()-1; c++) {
-                int idx = c + shift;
-                if (idx < 0)
-                    continue;
-                if (idx > erg[i].size()-1)
-                    continue;
-                int a = erg[i][idx];
-                int b = erg[j][c];
-                sumChange += (a!=b?1:0);
-                comparisons++;
-            }
-            float sc = sumChange/(comparisons>0?(float)comparisons:1.0f);
-            if (shift == startShift) { // init the values
+    float bestSumChange = 0.0;
+    int startShift = -(int)(first.size()-1)/2;
+    for (int shift = startShift; shift < (int)pattern.size()-1; shift++) { // do not count same pattern
+        int sumChange = 0;
+        int comparisons = 0;
+        for (int c = 0; c < first.size()-1; c++) {
+            int idx = c + shift;
+            if (idx < 0)
+                continue;
+            if (idx > pattern.size()-1)
+                continue;
+            int a = pattern[idx];
+            int b = first[c];
+            sumChange += (a!=b?1:0);
+            comparisons++;
+        }
+        float sc = sumChange/(comparisons>0?(float)comparisons:1.0f);
+        if (shift == startShift) { // init the values
+            bestShift = shift;
+            bestSumChange = sc;
+        } else {
+            if (bestSumChange > sc) {
                 bestShift = shift;
                 bestSumChange = sc;
-            } else {
-                if (bestSumChange > sc) {
-                    bestShift = shift;
-                    bestSumChange = sc;
-                }
             }
         }
-        result[i] = bestShift;
     }
-    return result;
+    return bestShift;
 }
 
 
+// Numbers for the event strings ("value [originator]") of a set of labels, in the order of the strings.
+// Log files with the same name in different folders share a string and get the same number.
+typedef struct {
+    std::vector<std::string> names; // string of each number
+    std::vector<int> number;        // label id -> number, -1 if the label was not given
+} event_dictionary_t;
+
+event_dictionary_t makeEventDictionary(const history_t *history, const std::vector<uint32_t> &labels) {
+    std::vector<std::pair<std::string, uint32_t> > named;
+    named.reserve(labels.size());
+    for (uint32_t label : labels)
+        named.push_back(std::make_pair(std::string(history->eventString(history->label_event[label])) + std::string(" [") +
+                                       originatorStem(history, history->label_originator[label]) + std::string("]"), label));
+    std::sort(named.begin(), named.end());
+    event_dictionary_t dict;
+    dict.number.assign(history->numLabels(), -1);
+    for (size_t i = 0; i < named.size(); i++) {
+        if (i == 0 || named[i].first != named[i-1].first)
+            dict.names.push_back(named[i].first);
+        dict.number[named[i].second] = dict.names.size() - 1;
+    }
+    return dict;
+}
+
+// A window of the history as input for the miner. Only events that repeat inside the window are kept,
+// they are numbered 1.. in dictionary order (item i is the dictionary number events[i-1]).
+typedef struct {
+    std::vector<std::vector<int> > items;    // one sequence per split
+    std::vector<std::vector<int> > position; // running number of each item, the gap constraint uses it
+    std::vector<std::vector<int> > seconds;  // seconds since the start of the window of each item, for the time gap
+    std::vector<int> events;
+    size_t numUnique; // number of different event strings in the window
+    int L;            // largest item in the sequences
+} window_sequences_t;
+
+window_sequences_t windowSequences(history_window_t horizon, const event_dictionary_t &dict, int numSplits) {
+    const history_t *history = horizon.history;
+    window_sequences_t seq;
+    // if an event does not repeat at least 2 times its not an event
+    std::unordered_map<int, int> item;
+    for (size_t i = horizon.begin; i < horizon.end; i++)
+        item[dict.number[history->label[i]]]++;
+    seq.numUnique = item.size();
+    for (auto it = item.begin(); it != item.end(); it++)
+        if ((*it).second > 1)
+            seq.events.push_back((*it).first);
+    std::sort(seq.events.begin(), seq.events.end());
+    // lookup table from dictionary number to item (0 if the event does not repeat)
+    for (auto it = item.begin(); it != item.end(); it++)
+        (*it).second = 0;
+    for (size_t i = 0; i < seq.events.size(); i++)
+        item[seq.events[i]] = i + 1;
+
+    // split the history into separate pieces of repeating events
+    seq.L = 0;
+    int counter = 0;
+    int64_t startSecond = (horizon.begin < horizon.end) ? history->time[horizon.begin] / 1000000000LL : 0;
+    int half = windowSize(horizon)/numSplits;
+    for (int split = 0; split < numSplits; split++) {
+        size_t start = horizon.begin + split * half;
+        size_t end = horizon.begin + (split + 1) * half;
+        if (split == numSplits-1)
+            end = horizon.end;
+        seq.items.push_back(std::vector<int>());
+        seq.position.push_back(std::vector<int>());
+        seq.seconds.push_back(std::vector<int>());
+        for (size_t i = start; i < end; i++) {
+            int idx = item[dict.number[history->label[i]]];
+            if (idx > 0) {
+                seq.items[split].push_back(idx);
+                if (seq.L < idx)
+                    seq.L = idx;
+                seq.position[split].push_back(counter++); // separate counter, entries that do not repeat leave no gap
+                seq.seconds[split].push_back(history->time[i] / 1000000000LL - startSecond); // whole seconds of the log time
+            }
+        }
+    }
+    return seq;
+}
+
+// The miner as LoCo uses it, the only constraints are the distance between the events of a pattern, at most
+// limit entries and at most limitSeconds seconds apart (0 or less: no limit). With bestPattern we get the
+// maxNumberOfPattern most frequent pattern instead of the first ones found.
+patterns::Seq2pat makeMiner(const window_sequences_t &seq, int limit, int limitSeconds, int minNumberObservations, int maxNumberOfPattern, bool bestPattern) {
+    // maybe easier to use the default: https://github.com/aminhn/HTMiner/blob/main/BDTrie/load_inst.cpp
+    patterns::Seq2pat algo = patterns::Seq2pat();
+    algo.M = 0; // Length of the largest sequence in items
+    for (int i = 0; i < seq.items.size(); i++)
+        if (algo.M < seq.items[i].size())
+            algo.M = seq.items[i].size();
+    algo.N = seq.items.size(); // Number of sequences in items
+    algo.L = seq.L; // Maximum value in events list (number of repeating events)
+    algo.items = seq.items;
+    algo.theta = minNumberObservations; // at least observe that many times
+    algo.tot_gap.push_back(1); // not sure why we define this... its needed to have the ugap test apply
+    // The MDD build stops looking for arcs as soon as the first attribute is too far away, the other one is only
+    // checked for the arcs left. Put the running number first, limit entries are quick to walk even in a burst.
+    if (limit > 0) {
+        algo.attrs.push_back(seq.position);
+        algo.ugapi.push_back(algo.attrs.size()-1); // what attr value to use
+        algo.ugap.push_back(limit); // max distance in number of entries between log entries (speed improvement)
+    }
+    if (limitSeconds > 0) {
+        algo.attrs.push_back(seq.seconds);
+        algo.ugapi.push_back(algo.attrs.size()-1);
+        algo.ugap.push_back(limitSeconds); // max distance in log time, bursty logs do not connect events hours apart
+    }
+    algo.max_number_of_pattern = maxNumberOfPattern;
+    if (bestPattern)
+        algo.top_k = maxNumberOfPattern; // theta goes up while the best pattern are found, less to search
+    return algo;
+}
+
+// Print one pattern of a window, the event at the shift position is marked with a '*'.
+void printPattern(int i, const std::vector<std::string> &names, int support, int shift) {
+    fprintf(stdout, "pattern \033[32m%02d\033[0m, length: %zu, %d times\n", i+1, names.size(), support);
+    for (int j = 0; j < names.size(); j++)
+        fprintf(stdout, "\t%s[%d] %s\n", (j==shift?"*":" "), j+1, names[j].c_str());
+}
+
 // Find unique sequences of events that repeat at least minNumberObservations times.
 // - numSplits[3]: split the single long history into equal length chunks of repeating events
 // - limit[20]: maximum allowed distance between log entries (in merged log history)
+// - limitSeconds[0]: maximum allowed time between log entries, 0 for no limit
+// - bestPattern: return the maxNumberOfPattern most frequent pattern (most frequent first), not the first ones found
 // - minNumberOfObservations[3]: can be set the same as numSplits
-std::pair<std::vector<std::vector< std::string > >, std::vector<int> > detectEvent(std::vector<HistoryEntry> *horizon, int numSplits = 3, int limit = 20, int minNumberObservations = 3, int maxNumberOfPattern = 10000) {
+// - keepPatterns: return the pattern strings as well (for save and display), otherwise they are only printed
+// - maxMineMillis[0]: stop mining after that many milliseconds and keep the pattern found so far (0 no limit)
+// - cancel: stop mining (same as running out of time) when this becomes true, e.g. on Ctrl-C
+// - support: if given it gets the number of matches of each pattern
+// - interrupted: if given it is set to true if mining stopped before all pattern were found
+std::pair<std::vector<std::vector< std::string > >, std::vector<int> > detectEvent(history_window_t horizon, int numSplits = 3, int limit = 20, int limitSeconds = 0, int minNumberObservations = 3, int maxNumberOfPattern = 10000, bool bestPattern = false, bool keepPatterns = true,
+                                                                                  int maxMineMillis = 0, const std::atomic<bool> *cancel = NULL,
+                                                                                  std::vector<int> *support = NULL, bool *interrupted = NULL) {
     // return a number of events that happen more than once
     std::vector<std::vector<std::string> > events;
-    std::vector<std::string> repeating_events_list;
 
-    // create a list of repeating events (based on string comparisons)
-    // if an event does not repeat at least 2 times its not an event
-    struct cmpByEditDistance {
-        bool operator()(const std::string& a, const std::string& b) const {
-            return a < b;
-            //return editDistDP(a, b);
-            // return editDistanceRecursive(a, b, a.size(), b.size());
-            // return a.length() < b.length();
-        }
-    };
+    // Every entry carries the id of its (value, originator) pair from ingest, only the labels
+    // in this window need a string.
+    const history_t *history = horizon.history;
+    std::unordered_set<uint32_t> seen;
+    for (size_t i = horizon.begin; i < horizon.end; i++)
+        seen.insert(history->label[i]);
+    event_dictionary_t dict = makeEventDictionary(history, std::vector<uint32_t>(seen.begin(), seen.end()));
+    window_sequences_t seq = windowSequences(horizon, dict, numSplits);
+    if (verbose)
+        fprintf(stdout, "%zu unique event%s, repeating events in this batch: %zu\n", seq.numUnique, (seq.numUnique!=1?"s":""), seq.events.size());
 
-    bool valuePlusOriginator = true;
+    patterns::Seq2pat algo = makeMiner(seq, limit, limitSeconds, minNumberObservations, maxNumberOfPattern, bestPattern);
+    algo.parallel = tbb::this_task_arena::max_concurrency() > 1; // mine on all cores of the arena, same pattern in the same order as the serial version
+    algo.max_mine_millis = maxMineMillis;
+    algo.cancel = cancel;
+    // print every pattern as soon as the miner finds it, the first one is the reference for the alignment
+    std::vector<int> patternShift;
+    std::vector<int> firstPattern;
+    // the sink stops the miner once it has maxNumberOfPattern (with bestPattern the miner hands over only that many),
+    // the limit in the miner only bounds the subtrees mined ahead in parallel, they cannot ask the sink
+    int numPattern = algo.mine([&](const std::vector<int> &pattern) {
+        if (maxNumberOfPattern > 0 && patternShift.size() >= maxNumberOfPattern)
+            return false;
+        if (firstPattern.empty())
+            firstPattern = pattern;
+        int match_location = (patternShift.size() == 0) ? 0 : computePatternShift(firstPattern, pattern); // no shift with itself
+        int i = patternShift.size();
+        patternShift.push_back(match_location);
+        std::vector<std::string> names;
+        for (int j = 0; j < pattern.size()-1; j++) // last element is number of matches, don't display that one
+            names.push_back(dict.names[seq.events[pattern[j]-1]]);
+        printPattern(i, names, pattern[pattern.size()-1], match_location);
+        if (support)
+            support->push_back(pattern[pattern.size()-1]);
+        if (keepPatterns)
+            events.push_back(names);
+        return true;
+    });
 
-    std::map<std::string, int, cmpByEditDistance> repeatingEvents;
-    for (int i = 0; i < horizon->size(); i++) {
-        std::string v = (*horizon)[i].getValue();
-        if (valuePlusOriginator) 
-            v += std::string(" [") + (*horizon)[i].getOriginator() + std::string("]");
-        if (repeatingEvents.find( v ) == repeatingEvents.end())
-            repeatingEvents.insert(std::pair<std::string, int>(v, 0));
-        repeatingEvents.insert(std::pair<std::string, int>(v, ++repeatingEvents[v]));
+    if (numPattern == 0) {
+        fprintf(stdout, "\033[31mNo pattern detected...\033[0m\n");
     }
-    auto it = repeatingEvents.begin();
-    while (it != repeatingEvents.end()) {
-        if ((*it).second > 1)
-            repeating_events_list.push_back((*it).first);
-        it++;
+    if (algo.interrupted) {
+        fprintf(stdout, "\033[33mMining stopped early, showing the %d pattern found so far.\033[0m\n", numPattern);
     }
-    if (verbose)
-        fprintf(stdout, "%zu unique event%s, repeating events in this batch: %zu\n", repeatingEvents.size(), (repeatingEvents.size()!=1?"s":""), repeating_events_list.size());
-
-    // create an alternative history based on our repeating events only, store position in repeating_events_list as identity of the string
-    std::vector<std::vector<int> > alternativeHistory;
-    std::vector<std::vector<int> > idx_attr;
-    bool testing = false;
-    int L = 0; // max value in history
-    int splits = numSplits; // make 3 sequences out of history, store in alternativeHistory
-    int counter = 0;
-    // split the history into separate pieces
-    int half = horizon->size()/splits;
-    for (int split = 0; split < splits; split++) {
-        int start = split * half;
-        int end = (split + 1) * half;
-        if (split == splits-1)
-            end = horizon->size();
-        alternativeHistory.push_back(std::vector<int>()); // we have only a single history here, we could have more for parallel processing?
-        idx_attr.push_back(std::vector<int>());
-        for (int i = start; i < end; i++) {
-            std::string v = (*horizon)[i].getValue();
-            if (valuePlusOriginator)
-                v += std::string(" [") + (*horizon)[i].getOriginator() + std::string("]");
-            auto it = std::find(repeating_events_list.begin(), repeating_events_list.end(), v);
-            if (it != repeating_events_list.end()) {
-                int idx = it - repeating_events_list.begin();
-                alternativeHistory[split].push_back(idx+1);
-                if (L < idx+1)
-                    L = idx+1;
-                idx_attr[split].push_back(counter++); // store a time, TODO: what happens if we do not find the event in the list, in that case i gets updated and we have a gap here, best to use a separate counter.. 
+    if (interrupted)
+        *interrupted = algo.interrupted;
+
+    return std::make_pair(events, patternShift);
+}
+
+// What a REPL query asks for. The window is identified by its first and last entry and the number of
+// entries in between, not by row numbers. Rows move when older entries are merged in, the entries do not.
+typedef struct {
+    int64_t first_time, last_time;
+    uint64_t first_hash, last_hash;
+    size_t size;
+    int numSplits, limit, limitSeconds, minNumberObservations, maxNumberOfPattern;
+    bool bestPattern;
+} pattern_query_t;
+
+// The pattern detectEvent found for a query, enough to print, save and display them again.
+typedef struct {
+    std::vector<std::vector<std::string> > events;
+    std::vector<int> support;
+    std::vector<int> patternShift;
+} pattern_result_t;
+
+// Least recently used cache of REPL query results. Re-issuing the same 'location, width' command
+// (e.g. after toggling display or save) prints the stored pattern instead of mining again.
+class PatternCache {
+    public:
+    size_t capacity;
+
+    PatternCache(size_t capacity = 32) : capacity(capacity) {}
+
+    static pattern_query_t query(history_window_t horizon, int numSplits, int limit, int limitSeconds, int minNumberObservations, int maxNumberOfPattern, bool bestPattern) {
+        const history_t *history = horizon.history;
+        pattern_query_t q = { 0, 0, 0, 0, windowSize(horizon), numSplits, limit, limitSeconds, minNumberObservations, maxNumberOfPattern, bestPattern };
+        if (q.size > 0) {
+            q.first_time = history->time[horizon.begin];
+            q.first_hash = history->hash[horizon.begin];
+            q.last_time = history->time[horizon.end - 1];
+            q.last_hash = history->hash[horizon.end - 1];
+        }
+        return q;
+    }
+
+    // the stored result for this query or NULL, a hit becomes the most recently used entry
+    const pattern_result_t *find(const pattern_query_t &q) {
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            if (!sameQuery((*it).first, q))
+                continue;
+            entries.splice(entries.begin(), entries, it);
+            return &entries.front().second;
+        }
+        return NULL;
+    }
+
+    void insert(const pattern_query_t &q, pattern_result_t result) {
+        if (capacity == 0)
+            return;
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            if (sameQuery((*it).first, q)) {
+                entries.erase(it);
+                break;
             }
         }
+        entries.emplace_front(q, std::move(result));
+        if (entries.size() > capacity)
+            entries.pop_back();
     }
 
-    // now use SPMF to find pattern
-    // maybe easier to use the default: https://github.com/aminhn/HTMiner/blob/main/BDTrie/load_inst.cpp
-    patterns::Seq2pat algo = patterns::Seq2pat();
-    algo.M = alternativeHistory[0].size(); // Length of the largest sequence in items
-    for (int i = 1; i < alternativeHistory.size(); i++)
-        if (algo.M < alternativeHistory[i].size())
-            algo.M = alternativeHistory[i].size();
-    algo.N = alternativeHistory.size(); // Number of sequences in items
-    algo.L = L; //repeating_events_list.size(); // Maximum value in events list (number of repeating events)
-    algo.items = alternativeHistory;
-    algo.theta = minNumberObservations; // algo.M * 0.00001; // 2; // at least observe twice
-    // no attributes, no constrains?
-    algo.tot_gap.push_back(1); // not sure why we define this... its needed to have the ugap test apply
-    algo.attrs.push_back(idx_attr);
-    //algo.lgapi.push_back(0); // which attribute to use
-    //algo.lgap.push_back(limit); // try to fix this again
-    algo.ugapi.push_back(0); // what attr value to use
-    algo.ugap.push_back(limit); // max distance in number of entries between log entries (speed improvement)
-    algo.max_number_of_pattern = maxNumberOfPattern;
-    std::vector< std::vector<int> > erg = algo.mine();
+    // Drop the queries whose window got new entries, call after updateHistory. The history is sorted,
+    // the first entry of a window is found with a binary search and the window is unchanged if its last
+    // entry is still size-1 rows further. Returns the number of dropped queries.
+    int invalidate(const history_t *history) {
+        int numDropped = 0;
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            const pattern_query_t &q = (*it).first;
+            size_t first = findRow(history, q.first_time, q.first_hash);
+            size_t last = first + q.size - 1;
+            bool same = first < history->size() && last < history->size() &&
+                        history->time[last] == q.last_time && history->hash[last] == q.last_hash;
+            if (same) {
+                it++;
+                continue;
+            }
+            it = entries.erase(it);
+            numDropped++;
+        }
+        return numDropped;
+    }
 
-    // erg contains our pattern, print those now
-    if (erg.size() == 0) {
-        fprintf(stdout, "\033[31mNo pattern detected...\033[0m\n");
+    size_t size() const {
+        return entries.size();
+    }
+
+    private:
+    std::list<std::pair<pattern_query_t, pattern_result_t> > entries; // most recently used first
+
+    static bool sameQuery(const pattern_query_t &a, const pattern_query_t &b) {
+        return a.first_time == b.first_time && a.last_time == b.last_time && a.first_hash == b.first_hash &&
+               a.last_hash == b.last_hash && a.size == b.size && a.numSplits == b.numSplits && a.limit == b.limit && a.limitSeconds == b.limitSeconds &&
+               a.minNumberObservations == b.minNumberObservations && a.maxNumberOfPattern == b.maxNumberOfPattern && a.bestPattern == b.bestPattern;
     }
-    std::vector<int> patternShift = computePatternShift(erg);
 
-    for (int i = 0; i < erg.size(); i++) {
-        events.push_back(std::vector<std::string>());
-        fprintf(stdout, "pattern \033[32m%02d\033[0m, length: %zu, %d times\n", i+1, erg[i].size()-1, erg[i][erg[i].size()-1]);
-        for (int j = 0; j < erg[i].size()-1; j++) { // last element is number of matches, don't display that one
-            // where is the best match?
-            int match_location = patternShift[i];
-            fprintf(stdout, "\t%s[%d] %s\n", (j==match_location?"*":" "), j+1, repeating_events_list[erg[i][j]-1].c_str());
-            events[events.size()-1].push_back(repeating_events_list[erg[i][j]-1]);
+    // row of the entry with this time and hash, history->size() if it is not in there
+    static size_t findRow(const history_t *history, int64_t time, uint64_t hash) {
+        auto lo = std::lower_bound(history->time.begin(), history->time.end(), time);
+        auto hi = std::upper_bound(lo, history->time.end(), time);
+        for (auto it = lo; it != hi; it++) // entries with the same time are sorted by hash
+            if (history->hash[it - history->time.begin()] == hash)
+                return it - history->time.begin();
+        return history->size();
+    }
+};
+
+// Pattern of one window of a sweep, events are numbers in the dictionary of the sweep.
+typedef struct {
+    history_window_t window;
+    std::vector<std::vector<int> > patterns; // last element of each pattern is the number of matches
+    bool interrupted;
+} sweep_window_t;
+
+// Rows of the history numbered for sweepChain, only events that repeat somewhere in the history are items.
+typedef struct {
+    std::vector<int> item;       // item of each row (1.., in dictionary order), 0 if the event never repeats
+    std::vector<int> events;     // dictionary number of each item (item i is events[i-1])
+    std::vector<size_t> prevRow; // row of the entry before/after with the same item (-1 if there is none)
+    std::vector<size_t> nextRow;
+} sweep_rows_t;
+
+sweep_rows_t sweepRows(const history_t *history, const event_dictionary_t &dict) {
+    sweep_rows_t rows;
+    size_t n = history->size();
+    std::vector<int> count(dict.names.size(), 0);
+    for (size_t i = 0; i < n; i++)
+        count[dict.number[history->label[i]]]++;
+    std::vector<int> itemOf(dict.names.size(), 0);
+    for (int number = 0; number < dict.names.size(); number++) {
+        if (count[number] > 1) {
+            rows.events.push_back(number);
+            itemOf[number] = rows.events.size();
         }
     }
+    rows.item.resize(n);
+    rows.prevRow.resize(n);
+    rows.nextRow.assign(n, (size_t)-1);
+    std::vector<size_t> last(rows.events.size() + 1, (size_t)-1);
+    for (size_t i = 0; i < n; i++) {
+        int item = itemOf[dict.number[history->label[i]]];
+        rows.item[i] = item;
+        rows.prevRow[i] = item > 0 ? last[item] : (size_t)-1;
+        if (item > 0 && last[item] != (size_t)-1)
+            rows.nextRow[last[item]] = i;
+        last[item] = i;
+    }
+    return rows;
+}
 
-    return std::make_pair(events, patternShift);
+// Mine the sweep windows [first, last) one after another. Every window is numSplits chunks of chunk rows
+// (chunk c is the rows [c * chunk, (c + 1) * chunk)), the sequences of windowSequences. A window shares most
+// of its chunks with the window before, the miner keeps their MDD and only the chunks that enter the window
+// are built. Chunks that stay change only if one of their events starts or stops repeating in the window,
+// those are built again. Pattern are the same as if every window was mined from scratch.
+void sweepChain(std::vector<sweep_window_t> &windows, size_t first, size_t last, size_t chunk, const sweep_rows_t &rows,
+                int limit, int limitSeconds, int minNumberObservations, int maxNumberOfPattern, bool bestPattern, int maxMineMillis, const std::atomic<bool> *cancel) {
+    const size_t none = (size_t)-1;
+    const history_t *history = windows[first].window.history;
+    window_sequences_t empty;
+    empty.L = rows.events.size();
+    patterns::Seq2pat algo;
+    std::vector<int> count(rows.events.size() + 1, 0); // entries of each item in the window
+    std::vector<int> before(rows.events.size() + 1, -1); // count of the items changed by a step before it
+    std::vector<size_t> deltaRow(rows.events.size() + 1);
+    std::vector<int> changed;
+    std::unordered_map<size_t, int> sequence;           // chunk -> id of its sequence in algo
+    size_t begin = 0, end = 0;                          // rows of the window mined last
+
+    auto addChunk = [&](size_t c) {
+        std::vector<int> items, position, seconds;
+        int64_t startSecond = history->time[c * chunk] / 1000000000LL;
+        for (size_t i = c * chunk; i < (c + 1) * chunk; i++) {
+            if (rows.item[i] > 0 && count[rows.item[i]] > 1) {
+                items.push_back(rows.item[i]);
+                position.push_back(position.size()); // only differences count for the gap constraints
+                seconds.push_back(history->time[i] / 1000000000LL - startSecond);
+            }
+        }
+        std::vector<std::vector<int> > attrs; // same attributes in the same order as makeMiner
+        if (limit > 0)
+            attrs.push_back(position);
+        if (limitSeconds > 0)
+            attrs.push_back(seconds);
+        sequence[c] = algo.add_sequence(items, attrs);
+    };
+    auto removeChunk = [&](size_t c) {
+        algo.remove_sequence(sequence[c]);
+        sequence.erase(c);
+    };
+
+    for (size_t w = first; w < last; w++) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            windows[w].interrupted = true;
+            continue;
+        }
+        history_window_t window = windows[w].window;
+        bool fresh = end <= window.begin; // nothing in common with the window before
+        std::set<size_t> dirty;
+        if (!fresh) {
+            // rows [begin, window.begin) leave and [end, window.end) enter the window, remember the count
+            // before and one of those rows for every item they have
+            auto touch = [&](size_t i, int change) {
+                int item = rows.item[i];
+                if (before[item] < 0) {
+                    before[item] = count[item];
+                    deltaRow[item] = i;
+                    changed.push_back(item);
+                }
+                count[item] += change;
+            };
+            for (size_t i = begin; i < window.begin; i++)
+                touch(i, -1);
+            for (size_t i = end; i < window.end; i++)
+                touch(i, 1);
+            // An item that starts or stops repeating has at most one entry in the rows both windows share,
+            // its neighbours in the history lead us there. That chunk has to be built again.
+            for (int item : changed) {
+                bool flipped = item > 0 && (before[item] > 1) != (count[item] > 1);
+                before[item] = -1;
+                if (!flipped)
+                    continue;
+                size_t i = deltaRow[item], shared = none;
+                if (i >= end) {
+                    for (i = rows.prevRow[i]; i != none && i >= end; i = rows.prevRow[i])
+                        ;
+                    if (i != none && i >= window.begin)
+                        shared = i;
+                } else {
+                    for (i = rows.nextRow[i]; i != none && i < window.begin; i = rows.nextRow[i])
+                        ;
+                    if (i != none && i < end)
+                        shared = i;
+                }
+                if (shared != none)
+                    dirty.insert(shared / chunk);
+            }
+            changed.clear();
+            // many rare events, most shared chunks change anyway. Also start over once the arena of
+            // the miner holds mostly removed sequences.
+            size_t numChunks = (window.end - window.begin) / chunk;
+            fresh = 2 * dirty.size() > (end - window.begin) / chunk || algo.N > 4 * numChunks;
+        }
+        if (fresh) {
+            algo = makeMiner(empty, limit, limitSeconds, minNumberObservations, maxNumberOfPattern, bestPattern);
+            std::fill(count.begin(), count.end(), 0);
+            sequence.clear();
+            for (size_t i = window.begin; i < window.end; i++)
+                count[rows.item[i]]++;
+            for (size_t c = window.begin / chunk; c < window.end / chunk; c++)
+                addChunk(c);
+        } else {
+            for (size_t c = begin / chunk; c < window.begin / chunk; c++)
+                removeChunk(c);
+            for (size_t c : dirty) {
+                removeChunk(c);
+                addChunk(c);
+            }
+            for (size_t c = end / chunk; c < window.end / chunk; c++)
+                addChunk(c);
+        }
+        begin = window.begin;
+        end = window.end;
+
+        algo.parallel = false; // the chains of windows already keep all cores busy
+        algo.max_mine_millis = maxMineMillis;
+        algo.cancel = cancel;
+        algo.mine([&](const std::vector<int> &pattern) {
+            std::vector<int> p(pattern);
+            for (size_t j = 0; j < p.size()-1; j++)
+                p[j] = rows.events[p[j]-1];
+            windows[w].patterns.push_back(std::move(p));
+            return true;
+        });
+        windows[w].interrupted = algo.interrupted;
+    }
+}
+
+// Mine every window of the whole history. Windows are width entries long and start every step entries,
+// with timeUnits width and step are seconds instead. All windows use one dictionary (dict) so pattern
+// of different windows can be compared. Windows are mined in parallel, each one by a single thread.
+std::vector<sweep_window_t> sweepHistory(const history_t *history, const event_dictionary_t &dict, int64_t step, int64_t width, bool timeUnits,
+                                         int numSplits = 3, int limit = 20, int limitSeconds = 0, int minNumberObservations = 3, int maxNumberOfPattern = 10000,
+                                         bool bestPattern = false, int maxMineMillis = 0, const std::atomic<bool> *cancel = NULL) {
+    std::vector<sweep_window_t> windows;
+    size_t n = history->size();
+    if (n == 0 || step <= 0 || width <= 0)
+        return windows;
+    if (timeUnits) {
+        int64_t first = history->time[0], last = history->time[n-1];
+        for (int64_t t = first; ; t += step * 1000000000LL) {
+            auto begin = std::lower_bound(history->time.begin(), history->time.end(), t);
+            auto end = std::lower_bound(begin, history->time.end(), t + width * 1000000000LL);
+            if (begin != end)
+                windows.push_back(sweep_window_t{ history_window_t{ history, (size_t)(begin - history->time.begin()), (size_t)(end - history->time.begin()) }, {}, false });
+            if (t + width * 1000000000LL > last)
+                break; // this window reached the end of the history
+        }
+    } else {
+        for (size_t begin = 0; begin < n; begin += step) {
+            size_t end = std::min(n, begin + (size_t)width);
+            windows.push_back(sweep_window_t{ history_window_t{ history, begin, end }, {}, false });
+            if (end == n)
+                break;
+        }
+    }
+
+    // A window mined from scratch
+    auto mineWindow = [&](size_t w) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            windows[w].interrupted = true;
+            return;
+        }
+        window_sequences_t seq = windowSequences(windows[w].window, dict, numSplits);
+        if (seq.L == 0)
+            return; // nothing repeats in here
+        patterns::Seq2pat algo = makeMiner(seq, limit, limitSeconds, minNumberObservations, maxNumberOfPattern, bestPattern);
+        algo.parallel = false; // the windows already keep all cores busy
+        algo.max_mine_millis = maxMineMillis;
+        algo.cancel = cancel;
+        algo.mine([&](const std::vector<int> &pattern) {
+            std::vector<int> p(pattern);
+            for (size_t j = 0; j < p.size()-1; j++)
+                p[j] = seq.events[p[j]-1];
+            windows[w].patterns.push_back(std::move(p));
+            return true;
+        });
+        windows[w].interrupted = algo.interrupted;
+    };
+
+    // If the windows are made of whole chunks (width/numSplits rows) they share sequences, every thread
+    // mines a run of consecutive windows and keeps the MDD between them. The last window can be shorter.
+    size_t chunk = width / numSplits;
+    size_t numFull = windows.size();
+    if (!timeUnits && !windows.empty() && chunk > 0 && width % numSplits == 0 && step % chunk == 0) {
+        if (windowSize(windows.back().window) != (size_t)width)
+            numFull--;
+        sweep_rows_t rows = sweepRows(history, dict);
+        size_t grain = std::max((size_t)1, numFull / (4 * tbb::this_task_arena::max_concurrency()));
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numFull, grain), [&](const tbb::blocked_range<size_t> &r) {
+            sweepChain(windows, r.begin(), r.end(), chunk, rows, limit, limitSeconds, minNumberObservations, maxNumberOfPattern, bestPattern, maxMineMillis, cancel);
+        }, tbb::simple_partitioner());
+    } else {
+        numFull = 0;
+    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(numFull, windows.size(), 1), [&](const tbb::blocked_range<size_t> &r) {
+        for (size_t w = r.begin(); w != r.end(); w++)
+            mineWindow(w);
+    });
+    return windows;
 }
 
 void displayPattern(std::vector<std::vector<std::string> > events, std::vector<int> patternShift) {
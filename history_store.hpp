@@ -0,0 +1,234 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+// what kind of log entry this is, stored as a single byte per entry
+enum entry_type_t : uint8_t { TYPE_UNKNOWN = 0, TYPE_INFO, TYPE_DEBUG, TYPE_ERROR, TYPE_WARNING };
+
+static const char *entry_type_names[] = { "UNKNOWN", "INFO", "DEBUG", "ERROR", "WARNING" };
+
+inline entry_type_t typeFromString(std::string_view type) {
+    for (int i = 1; i < 5; i++)
+        if (type == entry_type_names[i])
+            return (entry_type_t)i;
+    return TYPE_UNKNOWN;
+}
+
+// Columnar, append-optimised storage of the merged history. One row per log entry, sorted by
+// time (oldest first), entries with the same time are sorted by hash. Every column is a plain
+// array so windows of the history are contiguous memory. Event strings are stored only once in
+// a string arena, entries refer to them by id.
+class HistoryStore {
+    public:
+    // columns, all of them have size() entries
+    std::vector<int64_t> time;        // log time, nanoseconds since epoch
+    std::vector<uint64_t> hash;       // hash of value and originator, tie-breaker for equal times
+    std::vector<uint32_t> event;      // id of the value string
+    std::vector<uint32_t> originator; // id of the log file
+    std::vector<uint8_t> type;        // entry_type_t
+    std::vector<uint32_t> label;      // id of the (event, originator) pair, what detectEvent counts
+
+    // the distinct value strings back to back, event id i is arena[event_offset[i], event_offset[i+1])
+    std::string arena;
+    std::vector<uint64_t> event_offset = std::vector<uint64_t>(1, 0);
+    // log file names, originator id is the index
+    std::vector<std::string> originators;
+    std::vector<std::string> originator_stems; // file name without folder and extension, what we display
+    // label id i is the pair (label_event[i], label_originator[i])
+    std::vector<uint32_t> label_event;
+    std::vector<uint32_t> label_originator;
+
+    size_t size() const {
+        return time.size();
+    }
+
+    std::string_view eventString(uint32_t id) const {
+        return std::string_view(arena.data() + event_offset[id], event_offset[id + 1] - event_offset[id]);
+    }
+    std::string_view value(size_t row) const {
+        return eventString(event[row]);
+    }
+    size_t numEvents() const {
+        return event_offset.size() - 1;
+    }
+    size_t numLabels() const {
+        return label_event.size();
+    }
+
+    // return the id for this value string, add it to the arena if we have not seen it before
+    uint32_t internEvent(std::string_view v) {
+        auto it = event_ids.find(std::string(v));
+        if (it != event_ids.end())
+            return it->second;
+        uint32_t id = numEvents();
+        arena.append(v);
+        event_offset.push_back(arena.size());
+        event_ids.emplace(std::string(v), id);
+        return id;
+    }
+
+    uint32_t internOriginator(const std::string &filename) {
+        auto it = originator_ids.find(filename);
+        if (it != originator_ids.end())
+            return it->second;
+        uint32_t id = originators.size();
+        originators.push_back(filename);
+        originator_stems.push_back(std::filesystem::path(filename).stem().string());
+        originator_ids.emplace(filename, id);
+        return id;
+    }
+
+    // return the dense id of this (event, originator) pair, assigned once at ingest
+    uint32_t internLabel(uint32_t event, uint32_t originator) {
+        auto it = label_ids.find(labelKey(event, originator));
+        if (it != label_ids.end())
+            return it->second;
+        uint32_t id = numLabels();
+        label_event.push_back(event);
+        label_originator.push_back(originator);
+        label_ids.emplace(labelKey(event, originator), id);
+        return id;
+    }
+
+    // rebuild the lookup tables used by internEvent and internOriginator, needed after the
+    // arena and originators were filled directly (e.g. from a snapshot)
+    void reindex() {
+        event_ids.clear();
+        event_ids.reserve(numEvents());
+        for (uint32_t id = 0; id < numEvents(); id++)
+            event_ids.emplace(std::string(eventString(id)), id);
+        originator_ids.clear();
+        originator_stems.clear();
+        for (uint32_t id = 0; id < originators.size(); id++) {
+            originator_ids.emplace(originators[id], id);
+            originator_stems.push_back(std::filesystem::path(originators[id]).stem().string());
+        }
+        label_ids.clear();
+        label_ids.reserve(numLabels());
+        for (uint32_t id = 0; id < numLabels(); id++)
+            label_ids.emplace(labelKey(label_event[id], label_originator[id]), id);
+    }
+
+    // a single entry as it goes into the store
+    typedef struct {
+        int64_t time;
+        uint64_t hash;
+        uint32_t event;
+        uint32_t originator;
+        uint8_t type;
+        uint32_t label;
+    } row_t;
+
+    static bool rowLess(const row_t &a, const row_t &b) {
+        if (a.time != b.time)
+            return a.time < b.time;
+        if (a.hash != b.hash)
+            return a.hash < b.hash;
+        if (a.event != b.event)
+            return a.event < b.event;
+        return a.originator < b.originator;
+    }
+    static bool rowEqual(const row_t &a, const row_t &b) {
+        return a.time == b.time && a.hash == b.hash && a.event == b.event && a.originator == b.originator;
+    }
+
+    row_t row(size_t i) const {
+        return row_t{ time[i], hash[i], event[i], originator[i], type[i], label[i] };
+    }
+
+    // Merge new rows into the store. Rows do not have to be sorted, duplicates of entries already
+    // in the store (or inside rows) are dropped. If added_per_originator is given we count there how
+    // many rows of each originator made it into the store. Returns the number of rows added.
+    int merge(std::vector<row_t> &rows, std::vector<int> *added_per_originator = NULL) {
+        if (rows.empty())
+            return 0;
+        if (!std::is_sorted(rows.begin(), rows.end(), rowLess))
+            std::sort(rows.begin(), rows.end(), rowLess);
+        if (added_per_originator)
+            added_per_originator->resize(originators.size(), 0);
+
+        size_t n_old = size();
+        int numAdded = 0;
+        if (n_old == 0 || rowLess(row(n_old - 1), rows.front())) {
+            // all new entries come after the existing ones (the usual case when we tail logs), just append
+            reserve(n_old + rows.size());
+            for (size_t i = 0; i < rows.size(); i++) {
+                if (i > 0 && rowEqual(rows[i - 1], rows[i]))
+                    continue;
+                append(rows[i]);
+                if (added_per_originator)
+                    (*added_per_originator)[rows[i].originator]++;
+                numAdded++;
+            }
+            return numAdded;
+        }
+
+        // two-way merge of the existing columns with the new rows
+        HistoryStore merged;
+        merged.reserve(n_old + rows.size());
+        size_t a = 0, b = 0;
+        while (a < n_old || b < rows.size()) {
+            bool takeOld = (b == rows.size()) || (a < n_old && !rowLess(rows[b], row(a)));
+            row_t r = takeOld ? row(a++) : rows[b++];
+            if (merged.size() > 0 && rowEqual(merged.row(merged.size() - 1), r))
+                continue; // already in there
+            merged.append(r);
+            if (!takeOld) {
+                if (added_per_originator)
+                    (*added_per_originator)[r.originator]++;
+                numAdded++;
+            }
+        }
+        time.swap(merged.time);
+        hash.swap(merged.hash);
+        event.swap(merged.event);
+        originator.swap(merged.originator);
+        type.swap(merged.type);
+        label.swap(merged.label);
+        return numAdded;
+    }
+
+    private:
+    // only used during ingest to find the id of strings we have seen before
+    std::unordered_map<std::string, uint32_t> event_ids;
+    std::unordered_map<std::string, uint32_t> originator_ids;
+    std::unordered_map<uint64_t, uint32_t> label_ids;
+
+    static uint64_t labelKey(uint32_t event, uint32_t originator) {
+        return ((uint64_t)event << 32) | originator;
+    }
+
+    void reserve(size_t n) {
+        time.reserve(n);
+        hash.reserve(n);
+        event.reserve(n);
+        originator.reserve(n);
+        type.reserve(n);
+        label.reserve(n);
+    }
+    void append(const row_t &r) {
+        time.push_back(r.time);
+        hash.push_back(r.hash);
+        event.push_back(r.event);
+        originator.push_back(r.originator);
+        type.push_back(r.type);
+        label.push_back(r.label);
+    }
+};
+
+// A section of the history, rows [begin, end). Nothing is copied, the rows stay in the store.
+typedef struct {
+    const HistoryStore *history;
+    size_t begin;
+    size_t end;
+} history_window_t;
+
+inline size_t windowSize(const history_window_t &window) {
+    return window.end - window.begin;
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+// Binary snapshot of the history and of the import state of every log file. Lets us start
+// without parsing all the logs again, only files that changed since the snapshot are read.
+//
+// Layout (native byte order, every section starts at a multiple of 8 bytes):
+//   snapshot_header_t
+//   time[num_rows]  hash[num_rows]  event[num_rows]  originator[num_rows]  type[num_rows]  label[num_rows]
+//   event_offset[num_events+1]  arena[arena_size]  label_event[num_labels]  label_originator[num_labels]
+//   originators: num_originators x (uint64 length, bytes)
+//   files: num_files x (uint64 length, filename bytes, snapshot_file_t)
+// The numeric columns are copied straight out of the mapped file.
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "history.hpp"
+
+#define SNAPSHOT_MAGIC "LoCoSnap"
+#define SNAPSHOT_VERSION 2
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order; // 0x01020304 as written by this machine
+    uint64_t num_rows;
+    uint64_t num_events;
+    uint64_t arena_size;
+    uint64_t num_labels;
+    uint64_t num_originators;
+    uint64_t num_files;
+} snapshot_header_t;
+
+// the part of file_entry_t we need to continue importing a log file
+typedef struct {
+    int64_t last_write_time;    // file_time_type ticks
+    int64_t last_imported_time;
+    int64_t num_imported;
+    int64_t num_entries;
+    int64_t last_offset;
+    uint64_t inode;
+    int64_t last_size;
+} snapshot_file_t;
+
+// write bytes and pad with zeros to the next multiple of 8
+static bool writeSection(FILE *fp, const void *data, size_t bytes) {
+    static const char zeros[8] = { 0 };
+    if (bytes > 0 && fwrite(data, 1, bytes, fp) != bytes)
+        return false;
+    size_t pad = (8 - bytes % 8) % 8;
+    return fwrite(zeros, 1, pad, fp) == pad;
+}
+
+static bool writeString(FILE *fp, const std::string &str) {
+    uint64_t len = str.size();
+    return writeSection(fp, &len, sizeof(len)) && writeSection(fp, str.data(), len);
+}
+
+// Write the history and the log file states to filename. We write to a temporary file first and
+// rename it, a crash during the write leaves the previous snapshot intact.
+bool saveSnapshot(const std::string &filename, const history_t *history, const std::vector<file_entry_t> *log_files) {
+    std::string tmpname = filename + ".tmp";
+    FILE *fp = fopen(tmpname.c_str(), "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Error: could not write snapshot %s\n", tmpname.c_str());
+        return false;
+    }
+    snapshot_header_t header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = 0x01020304;
+    header.num_rows = history->size();
+    header.num_events = history->numEvents();
+    header.arena_size = history->arena.size();
+    header.num_labels = history->numLabels();
+    header.num_originators = history->originators.size();
+    header.num_files = log_files->size();
+
+    size_t n = history->size();
+    bool ok = writeSection(fp, &header, sizeof(header)) &&
+              writeSection(fp, history->time.data(), n * sizeof(int64_t)) &&
+              writeSection(fp, history->hash.data(), n * sizeof(uint64_t)) &&
+              writeSection(fp, history->event.data(), n * sizeof(uint32_t)) &&
+              writeSection(fp, history->originator.data(), n * sizeof(uint32_t)) &&
+              writeSection(fp, history->type.data(), n * sizeof(uint8_t)) &&
+              writeSection(fp, history->label.data(), n * sizeof(uint32_t)) &&
+              writeSection(fp, history->event_offset.data(), history->event_offset.size() * sizeof(uint64_t)) &&
+              writeSection(fp, history->arena.data(), history->arena.size()) &&
+              writeSection(fp, history->label_event.data(), history->numLabels() * sizeof(uint32_t)) &&
+              writeSection(fp, history->label_originator.data(), history->numLabels() * sizeof(uint32_t));
+    for (size_t i = 0; ok && i < history->originators.size(); i++)
+        ok = writeString(fp, history->originators[i]);
+    for (size_t i = 0; ok && i < log_files->size(); i++) {
+        const file_entry_t &f = (*log_files)[i];
+        snapshot_file_t sf = { .last_write_time = (int64_t)f.last_write_time.time_since_epoch().count(),
+                               .last_imported_time = (int64_t)f.last_imported_time.time_since_epoch().count(),
+                               .num_imported = f.num_imported, .num_entries = f.num_entries, .last_offset = f.last_offset,
+                               .inode = f.inode, .last_size = f.last_size };
+        ok = writeString(fp, f.filename) && writeSection(fp, &sf, sizeof(sf));
+    }
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok || rename(tmpname.c_str(), filename.c_str()) != 0) {
+        fprintf(stderr, "Error: could not write snapshot %s\n", filename.c_str());
+        unlink(tmpname.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Read a snapshot written by saveSnapshot into an empty history. Log files we know about get their
+// import state back (offsets and write times), so updateHistory only reads what is new. Files that
+// are in the snapshot but not in log_files keep their entries in the history.
+// Returns false (and leaves history empty) if the file does not exist or cannot be used.
+bool loadSnapshot(const std::string &filename, history_t *history, std::vector<file_entry_t> *log_files) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false; // no snapshot yet
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snapshot_header_t)) {
+        close(fd);
+        fprintf(stderr, "Warning: snapshot %s is too small, ignored\n", filename.c_str());
+        return false;
+    }
+    size_t fileSize = st.st_size;
+    const char *buf = (const char *)mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) {
+        fprintf(stderr, "Error: could not map snapshot %s\n", filename.c_str());
+        return false;
+    }
+
+    snapshot_header_t header;
+    memcpy(&header, buf, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 8) != 0 || header.version != SNAPSHOT_VERSION || header.byte_order != 0x01020304) {
+        fprintf(stderr, "Warning: snapshot %s has an unknown format (version %u), ignored\n", filename.c_str(), header.version);
+        munmap((void *)buf, fileSize);
+        return false;
+    }
+
+    // walk the sections, every read is checked against the end of the file
+    size_t pos = sizeof(header);
+    bool ok = true;
+    auto section = [&](size_t bytes) -> const char * {
+        if (!ok || bytes > fileSize - pos) { // before padding, a size from the file could wrap around
+            ok = false;
+            return NULL;
+        }
+        size_t padded = bytes + (8 - bytes % 8) % 8;
+        if (padded > fileSize - pos) {
+            ok = false;
+            return NULL;
+        }
+        const char *p = buf + pos;
+        pos += padded;
+        return p;
+    };
+    auto column = [&](auto &vec, size_t n) {
+        typedef typename std::remove_reference<decltype(vec)>::type::value_type value_t;
+        if (n > SIZE_MAX / sizeof(value_t)) { // n comes from the header
+            ok = false;
+            return;
+        }
+        const char *p = section(n * sizeof(value_t));
+        if (p) {
+            vec.resize(n);
+            memcpy(vec.data(), p, n * sizeof(value_t));
+        }
+    };
+    auto readString = [&]() -> std::string {
+        const char *p = section(sizeof(uint64_t));
+        if (!p)
+            return "";
+        uint64_t len;
+        memcpy(&len, p, sizeof(len));
+        p = section(len);
+        return p ? std::string(p, len) : std::string();
+    };
+
+    size_t n = header.num_rows;
+    column(history->time, n);
+    column(history->hash, n);
+    column(history->event, n);
+    column(history->originator, n);
+    column(history->type, n);
+    column(history->label, n);
+    if (header.num_events >= UINT32_MAX || header.num_labels > UINT32_MAX || header.num_originators > UINT32_MAX)
+        ok = false; // ids are 32 bit
+    column(history->event_offset, header.num_events + 1);
+    const char *arena = section(header.arena_size);
+    if (arena)
+        history->arena.assign(arena, header.arena_size);
+    column(history->label_event, header.num_labels);
+    column(history->label_originator, header.num_labels);
+    history->originators.clear();
+    for (uint64_t i = 0; ok && i < header.num_originators; i++)
+        history->originators.push_back(readString());
+    std::vector<std::pair<std::string, snapshot_file_t> > files;
+    for (uint64_t i = 0; ok && i < header.num_files; i++) {
+        std::string fn = readString();
+        const char *p = section(sizeof(snapshot_file_t));
+        if (p) {
+            snapshot_file_t sf;
+            memcpy(&sf, p, sizeof(sf));
+            files.push_back(std::make_pair(fn, sf));
+        }
+    }
+    munmap((void *)buf, fileSize);
+    if (!ok || history->event_offset.back() != history->arena.size()) {
+        fprintf(stderr, "Warning: snapshot %s is truncated, ignored\n", filename.c_str());
+        *history = history_t();
+        return false;
+    }
+    // every id has to point into its table, otherwise reindex() and the string lookups read past the end,
+    // and the rows have to be in time order for merge() and the window lookups
+    bool valid = history->event_offset[0] == 0 && std::is_sorted(history->time.begin(), history->time.end());
+    for (size_t i = 1; valid && i < history->event_offset.size(); i++)
+        valid = history->event_offset[i - 1] <= history->event_offset[i];
+    for (size_t i = 0; valid && i < n; i++)
+        valid = history->event[i] < header.num_events && history->originator[i] < header.num_originators && history->label[i] < header.num_labels &&
+                history->type[i] <= TYPE_WARNING;
+    for (size_t i = 0; valid && i < header.num_labels; i++)
+        valid = history->label_event[i] < header.num_events && history->label_originator[i] < header.num_originators;
+    if (!valid) {
+        fprintf(stderr, "Warning: snapshot %s is corrupt, ignored\n", filename.c_str());
+        *history = history_t();
+        return false;
+    }
+    history->reindex();
+
+    // restore the import state of the log files we still have
+    std::unordered_map<std::string, size_t> known;
+    for (size_t i = 0; i < files.size(); i++)
+        known[files[i].first] = i;
+    for (size_t i = 0; i < log_files->size(); i++) {
+        file_entry_t &f = (*log_files)[i];
+        auto it = known.find(f.filename);
+        if (it == known.end())
+            continue;
+        const snapshot_file_t &sf = files[it->second].second;
+        f.last_imported_time = std::filesystem::file_time_type(std::filesystem::file_time_type::duration(sf.last_imported_time));
+        f.num_imported = sf.num_imported;
+        f.num_entries = sf.num_entries;
+        f.last_offset = sf.last_offset;
+        f.inode = sf.inode;
+        f.last_size = sf.last_size;
+    }
+    return true;
+}